@@ -21,6 +21,7 @@
 #include <ostream>
 #include <fstream>
 #include <cstdint>
+#include <limits>
 //#include <compare>
 
 
@@ -144,6 +145,92 @@ struct area
 };
 
 
+/**
+   Axis-aligned bounding box, (x0, y0) top left to (x1, y1) bottom
+   right in SVG coordinates.
+
+   Default constructed boxes are empty, and extend to the first point
+   or box added.
+*/
+struct bbox
+{
+  space_type	_M_x0 = std::numeric_limits<space_type>::max();
+  space_type	_M_y0 = std::numeric_limits<space_type>::max();
+  space_type	_M_x1 = std::numeric_limits<space_type>::lowest();
+  space_type	_M_y1 = std::numeric_limits<space_type>::lowest();
+
+  constexpr bbox() = default;
+
+  constexpr
+  bbox(const space_type x0, const space_type y0,
+       const space_type x1, const space_type y1)
+  : _M_x0(x0), _M_y0(y0), _M_x1(x1), _M_y1(y1) { }
+
+  /// Box of width w and height h centered at p.
+  static constexpr bbox
+  centered_at(const point_2t p, const space_type w, const space_type h)
+  {
+    auto [ x, y ] = p;
+    return bbox(x - w / 2, y - h / 2, x + w / 2, y + h / 2);
+  }
+
+  constexpr bool
+  emptyp() const
+  { return _M_x0 > _M_x1 || _M_y0 > _M_y1; }
+
+  constexpr space_type
+  width() const
+  { return emptyp() ? 0 : _M_x1 - _M_x0; }
+
+  constexpr space_type
+  height() const
+  { return emptyp() ? 0 : _M_y1 - _M_y0; }
+
+  constexpr space_type
+  box_area() const
+  { return width() * height(); }
+
+  constexpr void
+  extend(const point_2t p)
+  {
+    auto [ x, y ] = p;
+    _M_x0 = std::min(_M_x0, x);
+    _M_y0 = std::min(_M_y0, y);
+    _M_x1 = std::max(_M_x1, x);
+    _M_y1 = std::max(_M_y1, y);
+  }
+
+  constexpr void
+  extend(const bbox& b)
+  {
+    _M_x0 = std::min(_M_x0, b._M_x0);
+    _M_y0 = std::min(_M_y0, b._M_y0);
+    _M_x1 = std::max(_M_x1, b._M_x1);
+    _M_y1 = std::max(_M_y1, b._M_y1);
+  }
+
+  /// Grow by d on all sides.
+  constexpr bbox
+  inflate(const space_type d) const
+  { return bbox(_M_x0 - d, _M_y0 - d, _M_x1 + d, _M_y1 + d); }
+
+  /// Overlap, touching edges do not count.
+  constexpr bool
+  intersectsp(const bbox& b) const
+  {
+    return _M_x0 < b._M_x1 && b._M_x0 < _M_x1
+      && _M_y0 < b._M_y1 && b._M_y0 < _M_y1;
+  }
+
+  constexpr bool
+  containsp(const bbox& b) const
+  {
+    return _M_x0 <= b._M_x0 && _M_y0 <= b._M_y0
+      && b._M_x1 <= _M_x1 && b._M_y1 <= _M_y1;
+  }
+};
+
+
 /// Datum consolidating style preferences.
 struct style
 {
@@ -48,30 +48,29 @@ constexpr colorband cband_p = std::make_tuple(color::purple, 33);
   Generate a color band from starting hue and seeds.
 
   Algorithm is average two known good, where two picked randomly.
+  Random values are drawn from rg, so a seeded rg gives a repeatable
+  band.
 
   Return type is a vector of generated color_qi types.
 */
+template<std::uniform_random_bit_generator _Rng>
 color_qis
 make_color_band_v1(const colorband& cb, const ushort neededh,
-		   auto& spectrum)
+		   const palette_table& spectrum, _Rng& rg)
 {
   // Find starting hue and number of samples in the color band.
   color c = std::get<0>(cb);
   ushort hn = std::get<1>(cb);
 
   // Find initial offset.
-  auto itr = std::find(spectrum.begin(), spectrum.end(), c);
-  if (itr == spectrum.end())
+  const ulong offset = spectrum.position(c);
+  if (offset == palette_table::npos)
     {
       string m("collection::make_color_band_v1: color " + to_string(c));
       m += " not found in spectrum of size ";
       m += std::to_string(spectrum.size());
       throw std::runtime_error(m);
     }
-  const ulong offset = std::distance(spectrum.begin(), itr);
-
-  // Randomness.
-  static std::mt19937_64 rg(std::random_device{}());
 
   // Setup random picker of sample hues in band.
   auto disti = std::uniform_int_distribution<>(0, hn - 1);
@@ -81,13 +80,14 @@ make_color_band_v1(const colorband& cb, const ushort neededh,
 
   // Generate new from averaging random samples, cache in return vector.
   color_qis cband;
+  cband.reserve(neededh);
   for (ushort i = 0; i < neededh; ++i)
     {
       // New color.
       ushort o1 = disti(rg);
       ushort o2 = disti(rg);
-      color_qi c1 = spectrum[offset + o1];
-      color_qi c2 = spectrum[offset + o2];
+      const color_qi& c1 = spectrum[offset + o1];
+      const color_qi& c2 = spectrum[offset + o2];
 
       // Combine.
       double c1r = distr(rg);
@@ -100,62 +100,97 @@ make_color_band_v1(const colorband& cb, const ushort neededh,
 }
 
 
-/// Algorithm is HSV generation.
+/// Generate a color band from a palette array, see above.
+/// @param rindex random stream index
+color_qis
+make_color_band_v1(const colorband& cb, const ushort neededh,
+		   auto& spectrum, const uint64_t rindex = next_random_index())
+{
+  random_stream rg(rindex);
+  return make_color_band_v1(cb, neededh, palette_table(spectrum), rg);
+}
+
+
+/**
+  Algorithm is HSV generation.
+
+  Random values are drawn from rg. Colors equivalent under
+  color_qf_lt are merged, keeping the first generated. Return is
+  sorted from light to dark.
+*/
+template<std::uniform_random_bit_generator _Rng>
 color_qis
-make_color_band_v2(const colorband& cb, const ushort neededh)
+make_color_band_v2(const colorband& cb, const ushort neededh, _Rng& rg)
 {
   // Find starting hue and number of samples in the color band.
   const auto [ klro, sz ] = cb;
   color_qi klr = klro;
 
   // Start with the original colorband.
-  std::set<color_qi> uklrs;
+  color_qis klrs;
+  klrs.reserve(sz + neededh);
   for (uint i = 0; i < sz; ++i)
     {
-      uklrs.insert(klr);
+      klrs.push_back(klr);
       klr = next_color(klr);
     }
-  std::cout << "colorband 1: " << std::to_string(uklrs.size()) << k::newline;
 
   // Add as necessary.
   klr = klro;
-  //  while (uklrs.size() < neededh)
   for (uint i = 0; i < neededh; i++)
     {
-      color_qf hhsv = mutate_color_qf(klr);
+      color_qf hhsv = mutate_color_qf(klr, rg);
       color_qi klrnu = hhsv.to_color_qi();
       if (klrnu == klro)
-	{
-	  string m("make_color_band_v2:: colorband looping error");
-	  m += k::newline;
-	  m += "starting color: ";
-	  m += to_string(klro) + k::newline;
-	  m += "starting color band size: ";
-	  m += std::to_string(sz) + k::newline;
-	  std::cout << m << k::newline;
-	  break;
-	}
-      uklrs.insert(klrnu);
+	break;
+      klrs.push_back(klrnu);
       klr = next_color(klr);
-      std::cout << to_string(klr) << k::tab << to_string(klrnu) << k::newline;
     }
-  std::cout << "colorband 2: " << std::to_string(uklrs.size()) << k::newline;
 
-  color_qis cband(uklrs.begin(), uklrs.end());
-  std::sort(cband.begin(), cband.end(), svg::color_qf_lt);
-  std::reverse(cband.begin(), cband.end());
+  // Order by distance to black, computed once per color.
+  static constexpr color_qf originklr = color::black;
+  using keyed = std::tuple<color_qf::ftype, color_qi>;
+  std::vector<keyed> keyeds;
+  keyeds.reserve(klrs.size());
+  for (const color_qi& k : klrs)
+    keyeds.push_back(std::make_tuple(color_qf_distance(k, originklr), k));
+
+  auto ltkey = [](const keyed& a, const keyed& b)
+  { return std::get<0>(a) < std::get<0>(b); };
+  auto eqkey = [](const keyed& a, const keyed& b)
+  { return std::get<0>(a) == std::get<0>(b); };
+  std::stable_sort(keyeds.begin(), keyeds.end(), ltkey);
+  keyeds.erase(std::unique(keyeds.begin(), keyeds.end(), eqkey),
+	       keyeds.end());
 
-  std::cout << "end colorband: " << std::to_string(sz) << k::newline;
+  color_qis cband;
+  cband.reserve(keyeds.size());
+  for (auto itr = keyeds.rbegin(); itr != keyeds.rend(); ++itr)
+    cband.push_back(std::get<1>(*itr));
   return cband;
 }
 
 
+/// Algorithm is HSV generation, see above.
+/// @param rindex random stream index
+color_qis
+make_color_band_v2(const colorband& cb, const ushort neededh,
+		   const uint64_t rindex = next_random_index())
+{
+  random_stream rg(rindex);
+  return make_color_band_v2(cb, neededh, rg);
+}
+
+
 /// Forwarding function.
+/// @param rindex random stream index
 color_qis
-make_color_band(const colorband& cb, const ushort neededh)
+make_color_band(const colorband& cb, const ushort neededh,
+		const uint64_t rindex = next_random_index())
 {
-  return make_color_band_v1(cb, neededh, active_spectrum());
-  //return make_color_band_v2(cb, neededh);
+  random_stream rg(rindex);
+  return make_color_band_v1(cb, neededh, active_palette_table(), rg);
+  //return make_color_band_v2(cb, neededh, rindex);
 }
 
 
@@ -621,6 +621,101 @@ static const palette_qi<12> esri_m_bathymetry_palette =
 /// Oklab
 /// https://bottosson.github.io/posts/oklab/
 
+/**
+   Palette prepared for constant time lookup.
+
+   Holds the colors of a palette as color_qi, packed RGB, HSV and
+   CIE L*a*b*, computed once, plus a hash index from packed RGB to
+   position. Where a color occurs more than once, the index is of
+   the first occurrence, as with std::find.
+*/
+class palette_table
+{
+public:
+  using index_type = uint;
+  using packeds = std::vector<color_rgb_packed>;
+
+  /// Position returned for colors not in the palette.
+  static constexpr index_type npos = index_type(-1);
+
+private:
+  color_qis					_M_qi;
+  packeds					_M_rgb;
+  color_qfs					_M_hsv;
+  color_labs					_M_lab;
+  std::unordered_map<color_rgb_packed, index_type>	_M_index;
+
+public:
+  palette_table() = default;
+
+  template<typename _Spectrm>
+  explicit
+  palette_table(const _Spectrm& spectrm)
+  {
+    const size_t n = spectrm.size();
+    _M_qi.reserve(n);
+    _M_rgb.reserve(n);
+    _M_hsv.reserve(n);
+    _M_lab.reserve(n);
+    _M_index.reserve(n);
+    for (const color_qi& k : spectrm)
+      {
+	_M_index.try_emplace(k.to_rgb_packed(), _M_qi.size());
+	_M_qi.push_back(k);
+	_M_rgb.push_back(k.to_rgb_packed());
+	_M_hsv.push_back(color_qf(k));
+	_M_lab.push_back(to_color_lab(k));
+      }
+  }
+
+  size_t
+  size() const
+  { return _M_qi.size(); }
+
+  const color_qi&
+  operator[](const size_t i) const
+  { return _M_qi[i]; }
+
+  const color_qis&
+  colors() const
+  { return _M_qi; }
+
+  const packeds&
+  rgb() const
+  { return _M_rgb; }
+
+  const color_qfs&
+  hsv() const
+  { return _M_hsv; }
+
+  const color_labs&
+  lab() const
+  { return _M_lab; }
+
+  /// Position of first klr in palette, or npos.
+  index_type
+  position(const color_qi klr) const
+  {
+    auto itr = _M_index.find(klr.to_rgb_packed());
+    return itr != _M_index.end() ? itr->second : npos;
+  }
+
+  /// Color after klr, wrapping at the end.
+  /// Iff klr is not found, return color::none.
+  color_qi
+  next(const color_qi klr) const
+  {
+    const index_type i = position(klr);
+    if (i == npos)
+      return color::none;
+    return _M_qi[(i + 1) % _M_qi.size()];
+  }
+};
+
+
+palette_table& active_palette_table();
+
+
 /// Set and Get working spectrum, aka default palette.
 /// NB: If colorbands are being used, palette has to be izzi or
 /// izzi_hue, and cannot be sorted color_qi as color bands use colors arranged
@@ -643,18 +738,32 @@ active_spectrum(const bool sortbyhuep = false)
       std::sort(spectrum.begin(), spectrum.end(), svg::color_qf_lt);
       std::reverse(spectrum.begin(), spectrum.end());
       initp = true;
+
+      // Keep index in step with new order.
+      active_palette_table() = palette_table(spectrum);
     }
   return spectrum;
 }
 
 
+/// Index of working spectrum.
+palette_table&
+active_palette_table()
+{
+  static palette_table table(active_spectrum());
+  return table;
+}
+
+
 /// Random entry from array above.
+/// @param rindex random stream index
 color_qi
-random_color(const uint startoffset = 0)
+random_color(const uint startoffset = 0,
+	     const uint64_t rindex = next_random_index())
 {
   auto& spectrum = active_spectrum();
   const uint maxc = spectrum.size();
-  static std::mt19937_64 rg(std::random_device{}());
+  random_stream rg(rindex);
   auto disti = std::uniform_int_distribution<>(startoffset, maxc - 1);
   uint index = disti(rg);
   return spectrum[index];
@@ -662,10 +771,11 @@ random_color(const uint startoffset = 0)
 
 template<typename _Spectrm>
 color_qi
-random_color(const _Spectrm& spectrm, const uint startoffset = 0)
+random_color(const _Spectrm& spectrm, const uint startoffset = 0,
+	     const uint64_t rindex = next_random_index())
 {
   const uint maxc = spectrm.size();
-  static std::mt19937_64 rg(std::random_device{}());
+  random_stream rg(rindex);
   auto disti = std::uniform_int_distribution<>(startoffset, maxc - 1);
   uint index = disti(rg);
   return spectrm[index];
@@ -675,19 +785,7 @@ random_color(const _Spectrm& spectrm, const uint startoffset = 0)
 /// Iff klr is not found, return color::none as the next color.
 color_qi
 next_color(const color_qi klr)
-{
-  auto& spectrum = active_spectrum();
-  color_qi cnext = color::none;
-  auto itr = std::find(spectrum.begin(), spectrum.end(), klr);
-  if (itr != spectrum.end())
-    {
-      ++itr;
-      if (itr == spectrum.end())
-	itr = spectrum.begin();
-      cnext = *itr;
-    }
-  return cnext;
-}
+{ return active_palette_table().next(klr); }
 
 /// Start at specified color bar entry point.
 color_qi
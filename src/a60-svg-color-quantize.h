@@ -0,0 +1,194 @@
+// svg color palette quantization -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_COLOR_QUANTIZE_H
+#define MiL_SVG_COLOR_QUANTIZE_H 1
+
+#include "a60-svg.h"
+#include <limits>
+#include <span>
+
+
+namespace svg {
+
+/**
+   Nearest palette color in perceptual space.
+
+   Palette colors are converted to CIE L*a*b* once and stored in a
+   k-d tree, laid out implicitly in one array: the root of each
+   subrange is its median, split on L*, a*, b* by depth. Queries are
+   O(log n) for palette size n instead of a scan of the palette.
+
+   Distance is CIE76 delta E, Euclidean in L*a*b*. Ties go to the
+   lowest palette position, as with a linear scan.
+
+   The color::none sentinel that ends izzi palettes is skipped by
+   default.
+*/
+class palette_quantizer
+{
+public:
+  using index_type = palette_table::index_type;
+
+private:
+  struct node
+  {
+    color_lab	lab;
+    index_type	id;		///< Position in source palette.
+  };
+
+  std::vector<node>	_M_nodes;
+  color_qis		_M_colors;
+
+  static color_lab::ftype
+  axis(const color_lab& k, const uint d)
+  { return d == 0 ? k.l : d == 1 ? k.a : k.b; }
+
+  void
+  build(const size_t lo, const size_t hi, const uint depth)
+  {
+    if (hi - lo < 2)
+      return;
+
+    const size_t mid = lo + (hi - lo) / 2;
+    const uint d = depth % 3;
+    std::nth_element(_M_nodes.begin() + lo, _M_nodes.begin() + mid,
+		     _M_nodes.begin() + hi,
+		     [d](const node& n1, const node& n2)
+		     { return axis(n1.lab, d) < axis(n2.lab, d); });
+    build(lo, mid, depth + 1);
+    build(mid + 1, hi, depth + 1);
+  }
+
+  void
+  search(const size_t lo, const size_t hi, const uint depth,
+	 const color_lab& q, color_lab::ftype& bestd, index_type& bestid) const
+  {
+    if (lo >= hi)
+      return;
+
+    const size_t mid = lo + (hi - lo) / 2;
+    const node& n = _M_nodes[mid];
+    const color_lab::ftype dist = color_lab_distance2(q, n.lab);
+    if (dist < bestd || (dist == bestd && n.id < bestid))
+      {
+	bestd = dist;
+	bestid = n.id;
+      }
+
+    // Near side first, far side only if the split plane is in range.
+    const color_lab::ftype delta = axis(q, depth % 3) - axis(n.lab, depth % 3);
+    if (delta < 0)
+      {
+	search(lo, mid, depth + 1, q, bestd, bestid);
+	if (delta * delta <= bestd)
+	  search(mid + 1, hi, depth + 1, q, bestd, bestid);
+      }
+    else
+      {
+	search(mid + 1, hi, depth + 1, q, bestd, bestid);
+	if (delta * delta <= bestd)
+	  search(lo, mid, depth + 1, q, bestd, bestid);
+      }
+  }
+
+public:
+  explicit
+  palette_quantizer(const palette_table& pt, const bool skipnonep = true)
+  : _M_colors(pt.colors())
+  {
+    const color_qi none(color::none);
+    _M_nodes.reserve(pt.size());
+    for (index_type i = 0; i < pt.size(); ++i)
+      if (!skipnonep || !(pt[i] == none))
+	_M_nodes.push_back(node { pt.lab()[i], i });
+    build(0, _M_nodes.size(), 0);
+  }
+
+  template<typename _Spectrm>
+  explicit
+  palette_quantizer(const _Spectrm& spectrm, const bool skipnonep = true)
+  : palette_quantizer(palette_table(spectrm), skipnonep)
+  { }
+
+  /// Number of colors searched.
+  size_t
+  size() const
+  { return _M_nodes.size(); }
+
+  /// Position in source palette of nearest color,
+  /// or palette_table::npos if the palette is empty.
+  index_type
+  nearest_index(const color_lab& q) const
+  {
+    color_lab::ftype bestd = std::numeric_limits<color_lab::ftype>::max();
+    index_type bestid = palette_table::npos;
+    search(0, _M_nodes.size(), 0, q, bestd, bestid);
+    return bestid;
+  }
+
+  index_type
+  nearest_index(const color_qi& k) const
+  { return nearest_index(to_color_lab(k)); }
+
+  /// Nearest palette color, or color::none if the palette is empty.
+  color_qi
+  nearest(const color_qi& k) const
+  {
+    const index_type i = nearest_index(k);
+    return i != palette_table::npos ? _M_colors[i] : color_qi(color::none);
+  }
+
+  /**
+     Batch query, out[i] is the palette position nearest to in[i].
+
+     Categorical maps repeat a small number of distinct input colors,
+     so each distinct packed RGB value is converted and searched once.
+  */
+  void
+  nearest_indices(std::span<const color_qi> in,
+		  std::span<index_type> out) const
+  {
+    std::unordered_map<color_rgb_packed, index_type> seen;
+    const size_t n = std::min(in.size(), out.size());
+    for (size_t i = 0; i < n; ++i)
+      {
+	const color_rgb_packed p = in[i].to_rgb_packed();
+	auto [ itr, insertp ] = seen.try_emplace(p, 0);
+	if (insertp)
+	  itr->second = nearest_index(in[i]);
+	out[i] = itr->second;
+      }
+  }
+
+  /// Batch query, return nearest palette color for each input color.
+  color_qis
+  quantize(const color_qis& in) const
+  {
+    std::vector<index_type> ids(in.size());
+    nearest_indices(in, ids);
+
+    color_qis ret;
+    ret.reserve(in.size());
+    for (const index_type i : ids)
+      ret.push_back(i != palette_table::npos ? _M_colors[i]
+					     : color_qi(color::none));
+    return ret;
+  }
+};
+
+} // namespace svg
+
+#endif
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <random>
 #include <iomanip>
+#include <span>
 
 
 namespace svg {
@@ -225,221 +226,251 @@ enum class color
 /// Total number of enumerated colors.
 constexpr uint color_max_size = static_cast<uint>(color::last);
 
+/// Color packed as 0xRRGGBB.
+using color_rgb_packed = uint;
+
+
+/// Packed RGB value of each enumerated color, indexed by enum value.
+/// Evaluation fails to compile if any color lacks a value.
+constexpr std::array<color_rgb_packed, color_max_size + 1> color_rgb_table = []
+{
+  std::array<color_rgb_packed, color_max_size + 1> a { };
+  std::array<bool, color_max_size + 1> seen { };
+  auto set = [&a, &seen](const color e, const uint r, const uint g,
+			 const uint b)
+  {
+    const uint i = static_cast<uint>(e);
+    a[i] = (r << 16) | (g << 8) | b;
+    seen[i] = true;
+  };
+
+  set(color::white, 255, 255, 255);
+  set(color::black, 0, 0, 0);
+  set(color::gray90, 25, 25, 25);
+  set(color::gray80, 50, 50, 50);
+  set(color::gray75, 64, 64, 64);
+  set(color::gray70, 77, 77, 77);
+  set(color::gray66, 87, 87, 87);
+  set(color::gray60, 100, 100, 100);
+  set(color::gray50, 128, 128, 128);
+  set(color::gray40, 150, 150, 150);
+  set(color::gray30, 180, 180, 180);
+  set(color::gray33, 171, 171, 171);
+  set(color::gray25, 191, 191, 191);
+  set(color::gray20, 200, 200, 200);
+  set(color::gray10, 230, 230, 230);
+  set(color::gray05, 242, 242, 242);
+  set(color::gray02, 248, 248, 248);
+  set(color::gray01, 252, 252, 252);
+
+  set(color::wcag_lgray, 148, 148, 148); // LG TXT on white 3:1
+  set(color::wcag_gray, 118, 118, 118); // min on white 4.5:1
+  set(color::wcag_dgray, 46, 46, 46); // on white 13.6:1
+
+  set(color::command, 255, 0, 171);
+  set(color::science, 150, 230, 191);
+  set(color::engineering, 161, 158, 178);
+
+  set(color::kissmepink, 255, 59, 241);
+
+  set(color::red, 255, 0, 0);
+  set(color::green, 0, 255, 0);
+  set(color::blue, 0, 0, 255);
+
+  set(color::asamablue, 1, 137, 255);
+  set(color::asamaorange, 236, 75, 37);
+  set(color::asamapink, 200, 56, 81);
+
+  // Yellows
+  set(color::kanzoiro, 255, 137, 54);
+  set(color::kohakuiro, 202, 105, 36);
+  set(color::kinsusutake, 125, 78, 45);
+  set(color::daylily, 255, 137, 54);
+  set(color::goldenyellow, 255, 164, 0);
+  set(color::hellayellow, 255, 255, 0);
+  set(color::antiquewhite, 250, 235, 215);
+  set(color::lemonchiffon, 255, 250, 205);
+  set(color::goldenrod, 250, 250, 210);
+  set(color::navajowhite, 255, 222, 173);
+
+  set(color::ivory, 255, 255, 240);
+  set(color::gold, 255, 215, 0);
+
+  set(color::duboisyellow1, 255, 255, 5);
+  set(color::duboisyellow2, 255, 234, 18);
+  set(color::duboisyellow3, 255, 215, 1);
+
+  // Orange
+  set(color::orange, 255, 165, 0);
+  set(color::orangered, 255, 69, 0);
+  set(color::redorange, 220, 48, 35);
+  set(color::darkorange, 255, 140, 17);
+  set(color::dutchorange, 250, 155, 30);
+  set(color::internationalorange, 255, 79, 0);
+
+  // Brown
+  set(color::duboisbrown1, 128, 5, 5);
+  set(color::duboisbrown2, 134, 90, 61);
+  set(color::duboisbrown3, 81, 55, 42);
+  set(color::duboisbrown4, 197, 146, 37);
+  set(color::duboisbrown5, 255, 240, 200);
+
+  // Reds
+  set(color::foreigncrimson, 201, 31, 55);
+  set(color::ginshu, 188, 45, 41);
+  set(color::akabeni, 195, 39, 43);
+  set(color::akebonoiro, 250, 123, 98);
+
+  set(color::ochre, 255, 78, 32);
+  set(color::sohi, 227, 92, 56);
+  set(color::benikaba, 157, 43, 34);
+  set(color::benitobi, 145, 50, 40);
+  set(color::ake, 207, 58, 36);
+
+  set(color::crimson, 220, 20, 60);
+  set(color::tomato, 255, 99, 71);
+  set(color::coral, 255, 127, 80);
+  set(color::salmon, 250, 128, 114);
+
+  set(color::duboisred1, 255, 29, 16);
+  set(color::duboisred2, 249, 110, 11);
+  set(color::duboisred3, 215, 25, 50);
+
+  // Greens
+  set(color::byakuroku, 165, 186, 147);
+  set(color::usumoegi, 141, 178, 85);
+  set(color::moegi, 91, 137, 48);
+  set(color::hiwamoegi, 122, 148, 46);
+  set(color::midori, 42, 96, 59);
+  set(color::rokusho, 64, 122, 82);
+  set(color::aotakeiro, 0, 100, 66);
+  set(color::seiheki, 58, 105, 96);
+  set(color::seijiiro, 129, 156, 139);
+  set(color::yanagizome, 140, 158, 94);
+
+  set(color::chartreuse, 127, 255, 0);
+  set(color::greenyellow, 173, 255, 47);
+  set(color::limegreen, 50, 205, 50);
+  set(color::springgreen, 0, 255, 127);
+  set(color::aquamarine, 127, 255, 212);
+
+  set(color::duboisgreen1, 5, 255, 5);
+  set(color::duboisgreen2, 127, 225, 15);
+  set(color::duboisgreen3, 16, 114, 9);
+  set(color::duboisgreen4, 0, 148, 16);
+  set(color::duboisgreen5, 24, 57, 30);
+
+  // Blues
+  set(color::ultramarine, 93, 140, 174);
+  set(color::shinbashiiro, 0, 108, 127);
+  set(color::hanada, 4, 79, 103);
+  set(color::ruriiro, 31, 71, 136);
+  set(color::bellflower, 25, 31, 69);
+  set(color::navy, 0, 49, 113);
+  set(color::asagiiro, 72, 146, 155);
+  set(color::indigo, 38, 67, 72);
+  set(color::rurikon, 27, 41, 75);
+  set(color::cyan, 0, 255, 255);
+
+  set(color::lightcyan, 224, 255, 255);
+  set(color::powderblue, 176, 224, 230);
+  set(color::steelblue, 70, 130, 237);
+  set(color::cornflowerblue, 100, 149, 237);
+  set(color::deepskyblue, 0, 191, 255);
+  set(color::dodgerblue, 30, 144, 255);
+  set(color::lightblue, 173, 216, 230);
+  set(color::skyblue, 135, 206, 235);
+  set(color::lightskyblue, 173, 206, 250);
+  set(color::midnightblue, 25, 25, 112);
+
+  set(color::mediumblue, 0, 0, 205);
+  set(color::royalblue, 65, 105, 225);
+  set(color::darkslateblue, 72, 61, 139);
+  set(color::slateblue, 106, 90, 205);
+  set(color::azure, 240, 255, 255);
+  set(color::crayolacerulean, 29, 172, 214);
+
+  set(color::duboisblue1, 37, 42, 255);
+  set(color::duboisblue2, 100, 150, 245);
+  set(color::duboisblue3, 74, 87, 129);
+  set(color::duboisblue4, 49, 64, 103);
+
+  set(color::blueprintlight, 0, 25, 166);
+  set(color::blueprint, 0, 20, 132);
+  set(color::blueprintdark, 0, 16, 106);
+
+  // Purples
+  set(color::wisteria, 135, 95, 154);
+  set(color::murasaki, 79, 40, 75);
+  set(color::ayameiro, 118, 53, 104);
+  set(color::peony, 164, 52, 93);
+  set(color::futaai, 97, 78, 110);
+  set(color::benimidori, 120, 119, 155);
+  set(color::redwisteria, 187, 119, 150);
+  set(color::botan, 164, 52, 93);
+  set(color::kokimurasaki, 58, 36, 59);
+  set(color::usuiro, 168, 124, 160);
+
+  set(color::blueviolet, 138, 43, 226);
+  set(color::darkmagenta, 139, 0, 139);
+  set(color::darkviolet, 148, 0, 211);
+  set(color::thistle, 216, 191, 216);
+  set(color::plum, 221, 160, 221);
+  set(color::violet, 238, 130, 238);
+  set(color::magenta, 255, 0, 255);
+  set(color::dfuschia, 255, 35, 255);
+  set(color::deeppink, 255, 20, 147);
+  set(color::hotpink, 255, 105, 180);
+  set(color::pink, 255, 192, 203);
+
+  set(color::palevioletred, 219, 112, 147);
+  set(color::mediumvioletred, 199, 21, 133);
+  set(color::lavender, 230, 230, 250);
+  set(color::orchid, 218, 112, 214);
+  set(color::mediumorchid, 186, 85, 211);
+  set(color::darkestmagenta, 180, 0, 180);
+  set(color::mediumpurple, 147, 112, 219);
+  set(color::purple, 128, 0, 128);
+  set(color::dustyrose, 191, 136, 187);
+  set(color::atmosphericp, 228, 210, 231);
+
+  set(color::none, 1, 0, 0);
+  set(color::last, 0, 0, 1);
+
+  // Error check to make sure all the colors have values.
+  for (const bool seenp : seen)
+    if (!seenp)
+      throw std::logic_error("color_rgb_table:: color without value");
+  return a;
+}();
+
+
+/// Packed RGB value of color.
+constexpr color_rgb_packed
+to_rgb_packed(const color e)
+{ return color_rgb_table[static_cast<uint>(e)]; }
+
+
 /// Convert color to RGB color value string.
 const std::string&
 to_string(const color e)
 {
-  using enum_map_type = std::map<color, std::string>;
+  using names_type = std::array<std::string, color_max_size + 1>;
 
-  static enum_map_type enum_map;
-  if (enum_map.empty())
-    {
-      enum_map[color::white] = "rgb(255, 255, 255)";
-      enum_map[color::black] = "rgb(0, 0, 0)";
-      enum_map[color::gray90] = "rgb(25, 25, 25)";
-      enum_map[color::gray80] = "rgb(50, 50, 50)";
-      enum_map[color::gray75] = "rgb(64, 64, 64)";
-      enum_map[color::gray70] = "rgb(77, 77, 77)";
-      enum_map[color::gray66] = "rgb(87, 87, 87)";
-      enum_map[color::gray60] = "rgb(100, 100, 100)";
-      enum_map[color::gray50] = "rgb(128, 128, 128)";
-      enum_map[color::gray40] = "rgb(150, 150, 150)";
-      enum_map[color::gray30] = "rgb(180, 180, 180)";
-      enum_map[color::gray33] = "rgb(171, 171, 171)";
-      enum_map[color::gray25] = "rgb(191, 191, 191)";
-      enum_map[color::gray20] = "rgb(200, 200, 200)";
-      enum_map[color::gray10] = "rgb(230, 230, 230)";
-      enum_map[color::gray05] = "rgb(242, 242, 242)";
-      enum_map[color::gray02] = "rgb(248, 248, 248)";
-      enum_map[color::gray01] = "rgb(252, 252, 252)";
-
-      enum_map[color::wcag_lgray] = "rgb(148, 148, 148)"; // LG TXT on white 3:1
-      enum_map[color::wcag_gray] = "rgb(118, 118, 118)"; // min on white 4.5:1
-      enum_map[color::wcag_dgray] = "rgb(46, 46, 46)"; // on white 13.6:1
-
-      enum_map[color::command] = "rgb(255, 0, 171)";
-      enum_map[color::science] = "rgb(150, 230, 191)";
-      enum_map[color::engineering] = "rgb(161, 158, 178)";
-
-      enum_map[color::kissmepink] = "rgb(255, 59, 241)";
-
-      enum_map[color::red] = "rgb(255, 0, 0)";
-      enum_map[color::green] = "rgb(0, 255, 0)";
-      enum_map[color::blue] = "rgb(0, 0, 255)";
-
-      enum_map[color::asamablue] = "rgb(1, 137, 255)";
-      enum_map[color::asamaorange] = "rgb(236, 75, 37)";
-      enum_map[color::asamapink] = "rgb(200, 56, 81)";
-
-      // Yellows
-      enum_map[color::kanzoiro] = "rgb(255, 137, 54)";
-      enum_map[color::kohakuiro] = "rgb(202, 105, 36)";
-      enum_map[color::kinsusutake] = "rgb(125, 78, 45)";
-      enum_map[color::daylily] = "rgb(255, 137, 54)";
-      enum_map[color::goldenyellow] = "rgb(255, 164, 0)";
-      enum_map[color::hellayellow] = "rgb(255, 255, 0)";
-      enum_map[color::antiquewhite] = "rgb(250, 235, 215)";
-      enum_map[color::lemonchiffon] = "rgb(255, 250, 205)";
-      enum_map[color::goldenrod] = "rgb(250, 250, 210)";
-      enum_map[color::navajowhite] = "rgb(255, 222, 173)";
-
-      enum_map[color::ivory] = "rgb(255, 255, 240)";
-      enum_map[color::gold] = "rgb(255, 215, 0)";
-
-      enum_map[color::duboisyellow1] = "rgb(255, 255, 5)";
-      enum_map[color::duboisyellow2] = "rgb(255, 234, 18)";
-      enum_map[color::duboisyellow3] = "rgb(255, 215, 1)";
-
-      // Orange
-      enum_map[color::orange] = "rgb(255, 165, 0)";
-      enum_map[color::orangered] = "rgb(255, 69, 0)";
-      enum_map[color::redorange] = "rgb(220, 48, 35)";
-      enum_map[color::darkorange] = "rgb(255, 140, 17)";
-      enum_map[color::dutchorange] = "rgb(250, 155, 30)";
-      enum_map[color::internationalorange] = "rgb(255, 79, 0)";
-
-      // Brown
-      enum_map[color::duboisbrown1] = "rgb(128, 5, 5)";
-      enum_map[color::duboisbrown2] = "rgb(134, 90, 61)";
-      enum_map[color::duboisbrown3] = "rgb(81, 55, 42)";
-      enum_map[color::duboisbrown4] = "rgb(197, 146, 37)";
-      enum_map[color::duboisbrown5] ="rgb(255, 240, 200)";
-
-      // Reds
-      enum_map[color::foreigncrimson] = "rgb(201, 31, 55)";
-      enum_map[color::ginshu] = "rgb(188, 45, 41)";
-      enum_map[color::akabeni] = "rgb(195, 39,43)";
-      enum_map[color::akebonoiro] = "rgb(250, 123, 98)";
-
-      enum_map[color::ochre] = "rgb(255, 78, 32)";
-      enum_map[color::sohi] = "rgb(227, 92, 56)";
-      enum_map[color::benikaba] = "rgb(157, 43, 34)";
-      enum_map[color::benitobi] = "rgb(145, 50, 40)";
-      enum_map[color::ake] = "rgb(207, 58, 36)";
-
-      enum_map[color::crimson] = "rgb(220, 20, 60)";
-      enum_map[color::tomato] = "rgb(255, 99, 71)";
-      enum_map[color::coral] = "rgb(255, 127, 80)";
-      enum_map[color::salmon] = "rgb(250, 128, 114)";
-
-      enum_map[color::duboisred1] = "rgb(255, 29, 16)";
-      enum_map[color::duboisred2] = "rgb(249,110, 11)";
-      enum_map[color::duboisred3] = "rgb(215, 25, 50)";
-
-      // Greens
-      enum_map[color::byakuroku] = "rgb(165, 186, 147)";
-      enum_map[color::usumoegi] = "rgb(141, 178, 85)";
-      enum_map[color::moegi] = "rgb(91, 137, 48)";
-      enum_map[color::hiwamoegi] = "rgb(122, 148, 46)";
-      enum_map[color::midori] = "rgb(42, 96, 59)";
-      enum_map[color::rokusho] = "rgb(64, 122, 82)";
-      enum_map[color::aotakeiro] = "rgb(0, 100, 66)";
-      enum_map[color::seiheki] = "rgb(58, 105, 96)";
-      enum_map[color::seijiiro] = "rgb(129, 156, 139)";
-      enum_map[color::yanagizome] = "rgb(140, 158, 94)";
-
-      enum_map[color::chartreuse] = "rgb(127, 255, 0)";
-      enum_map[color::greenyellow] = "rgb(173, 255, 47)";
-      enum_map[color::limegreen] = "rgb(50, 205, 50)";
-      enum_map[color::springgreen] = "rgb(0, 255, 127)";
-      enum_map[color::aquamarine] = "rgb(127, 255, 212)";
-
-      enum_map[color::duboisgreen1] = "rgb(5, 255, 5)";
-      enum_map[color::duboisgreen2] = "rgb(127, 225, 15)";
-      enum_map[color::duboisgreen3] = "rgb(16, 114, 9)";
-      enum_map[color::duboisgreen4] = "rgb(0, 148, 16)";
-      enum_map[color::duboisgreen5] = "rgb(24, 57, 30)";
-
-      // Blues
-      enum_map[color::ultramarine] = "rgb(93, 140, 174)";
-      enum_map[color::shinbashiiro] = "rgb(0, 108, 127)";
-      enum_map[color::hanada] = "rgb(4, 79, 103)";
-      enum_map[color::ruriiro] = "rgb(31, 71, 136)";
-      enum_map[color::bellflower] = "rgb(25, 31, 69)";
-      enum_map[color::navy] = "rgb(0, 49, 113)";
-      enum_map[color::asagiiro] = "rgb(72, 146, 155)";
-      enum_map[color::indigo] = "rgb(38, 67, 72)";
-      enum_map[color::rurikon] = "rgb(27, 41, 75)";
-      enum_map[color::cyan] = "rgb(0, 255, 255)";
-
-      enum_map[color::lightcyan] = "rgb(224, 255, 255)";
-      enum_map[color::powderblue] = "rgb(176, 224, 230)";
-      enum_map[color::steelblue] = "rgb(70, 130, 237)";
-      enum_map[color::cornflowerblue] = "rgb(100, 149, 237)";
-      enum_map[color::deepskyblue] = "rgb(0, 191, 255)";
-      enum_map[color::dodgerblue] = "rgb(30, 144, 255)";
-      enum_map[color::lightblue] = "rgb(173, 216, 230)";
-      enum_map[color::skyblue] = "rgb(135, 206, 235)";
-      enum_map[color::lightskyblue] = "rgb(173, 206, 250)";
-      enum_map[color::midnightblue] = "rgb(25, 25, 112)";
-
-      enum_map[color::mediumblue] = "rgb(0, 0, 205)";
-      enum_map[color::royalblue] = "rgb(65, 105, 225)";
-      enum_map[color::darkslateblue] = "rgb(72, 61, 139)";
-      enum_map[color::slateblue] = "rgb(106, 90, 205)";
-      enum_map[color::azure] = "rgb(240, 255, 255)";
-      enum_map[color::crayolacerulean] = "rgb(29, 172, 214)";
-
-      enum_map[color::duboisblue1] = "rgb(37, 42, 255)";
-      enum_map[color::duboisblue2] = "rgb(100, 150, 245)";
-      enum_map[color::duboisblue3] = "rgb(74, 87, 129)";
-      enum_map[color::duboisblue4] = "rgb(49, 64, 103)";
-
-      enum_map[color::blueprintlight] = "rgb(0, 25, 166)";
-      enum_map[color::blueprint] = "rgb(0, 20, 132)";
-      enum_map[color::blueprintdark] = "rgb(0, 16, 106)";
-
-      // Purples
-      enum_map[color::wisteria] = "rgb(135, 95, 154)";
-      enum_map[color::murasaki] = "rgb(79, 40, 75)";
-      enum_map[color::ayameiro] = "rgb(118, 53, 104)";
-      enum_map[color::peony] = "rgb(164, 52, 93)";
-      enum_map[color::futaai] = "rgb(97, 78, 110)";
-      enum_map[color::benimidori] = "rgb(120, 119, 155)";
-      enum_map[color::redwisteria] = "rgb(187, 119, 150)";
-      enum_map[color::botan] = "rgb(164, 52, 93)";
-      enum_map[color::kokimurasaki] = "rgb(58, 36, 59)";
-      enum_map[color::usuiro] = "rgb(168, 124, 160)";
-
-      enum_map[color::blueviolet] = "rgb(138, 43, 226)";
-      enum_map[color::darkmagenta] = "rgb(139, 0, 139)";
-      enum_map[color::darkviolet] = "rgb(148, 0, 211)";
-      enum_map[color::thistle] = "rgb(216, 191, 216)";
-      enum_map[color::plum] = "rgb(221, 160, 221)";
-      enum_map[color::violet] = "rgb(238, 130, 238)";
-      enum_map[color::magenta] = "rgb(255, 0, 255)";
-      enum_map[color::dfuschia] = "rgb(255, 35, 255)";
-      enum_map[color::deeppink] = "rgb(255, 20, 147)";
-      enum_map[color::hotpink] = "rgb(255, 105, 180)";
-      enum_map[color::pink] = "rgb(255, 192, 203)";
-
-      enum_map[color::palevioletred] = "rgb(219, 112, 147)";
-      enum_map[color::mediumvioletred] = "rgb(199, 21, 133)";
-      enum_map[color::lavender] = "rgb(230, 230, 250)";
-      enum_map[color::orchid] = "rgb(218, 112, 214)";
-      enum_map[color::mediumorchid] = "rgb(186, 85, 211)";
-      enum_map[color::darkestmagenta] = "rgb(180, 0, 180)";
-      enum_map[color::mediumpurple] = "rgb(147, 112, 219)";
-      enum_map[color::purple] = "rgb(128, 0, 128)";
-      enum_map[color::dustyrose] = "rgb(191, 136, 187)";
-      enum_map[color::atmosphericp] = "rgb(228, 210, 231)";
-
-      enum_map[color::none] = "rgb(1, 0, 0)";
-      enum_map[color::last] = "rgb(0, 0, 1)";
-
-      // Error check to make sure all the colors have names/values.
-      if (enum_map.size() != color_max_size + 1)
-	{
-	  string m("to_string(color)::color map size fail ");
-	  m += k::newline;
-	  m += std::to_string(enum_map.size());
-	  m += " not equal to named colors of size ";
-	  m += k::newline;
-	  m += std::to_string(color_max_size);
-	  throw std::runtime_error(m);
-	}
-    }
-  return enum_map[e];
+  // Formatted once, then indexed by enum value.
+  static const names_type names = []
+  {
+    names_type ns;
+    for (uint i = 0; i < ns.size(); ++i)
+      {
+	const color_rgb_packed p = color_rgb_table[i];
+	ns[i] = "rgb(" + std::to_string((p >> 16) & 0xff) + ", "
+	  + std::to_string((p >> 8) & 0xff) + ", "
+	  + std::to_string(p & 0xff) + ")";
+      }
+    return ns;
+  }();
+  return names[static_cast<uint>(e)];
 }
 
 
@@ -458,9 +489,8 @@ struct color_qi
   static string
   to_string(color_qi s)
   {
-    std::ostringstream oss;
-    oss << "rgb(" << s.r << ',' << s.g << ',' << s.b << ")";
-    return oss.str();
+    return "rgb(" + std::to_string(s.r) + ',' + std::to_string(s.g) + ','
+      + std::to_string(s.b) + ")";
   }
 
   // From "rgb(64, 64, 64)";
@@ -505,23 +535,24 @@ struct color_qi
   }
 
   color_qi() = default;
-  color_qi(const color_qi&) = default;
-  color_qi& operator=(const color_qi&) = default;
+  constexpr color_qi(const color_qi&) = default;
+  constexpr color_qi& operator=(const color_qi&) = default;
 
   // auto operator<=>(const color_qi&) const = default;
 
-  color_qi(itype ra, itype ga, itype ba) : r(ra), g(ga), b(ba) { }
+  constexpr color_qi(itype ra, itype ga, itype ba) : r(ra), g(ga), b(ba) { }
 
-  color_qi(const color e)
-  {
-    color_qi klr = from_string(svg::to_string(e));
-    r = klr.r;
-    b = klr.b;
-    g = klr.g;
-  }
+  explicit constexpr color_qi(const color_rgb_packed p)
+  : r((p >> 16) & 0xff), g((p >> 8) & 0xff), b(p & 0xff) { }
+
+  constexpr color_qi(const color e) : color_qi(svg::to_rgb_packed(e)) { }
+
+  constexpr color_rgb_packed
+  to_rgb_packed() const
+  { return (uint(r) << 16) | (uint(g) << 8) | uint(b); }
 };
 
-inline bool
+constexpr bool
 operator==(const color_qi& c1, const color_qi& c2)
 {
   const bool t1 = c1.r == c2.r;
@@ -552,27 +583,17 @@ struct color_qf
   ftype	v; /// Value between 0.0 (black) and 1.0
 
   color_qf() = default;
-  color_qf(const color_qf&) = default;
-  color_qf& operator=(const color_qf&) = default;
+  constexpr color_qf(const color_qf&) = default;
+  constexpr color_qf& operator=(const color_qf&) = default;
 
   // auto operator<=>(const color_qf&) const = default;
 
-  color_qf(ftype vh, ftype vs, ftype vv) : h(vh), s(vs), v(vv) { }
+  constexpr color_qf(ftype vh, ftype vs, ftype vv) : h(vh), s(vs), v(vv) { }
 
   // Conversion constructor, convert from RGB to HSV.
-  color_qf(const color_qi& cqi)
-  {
-    auto hsv = rgb_to_hsv(cqi);
-    h = hsv.h;
-    s = hsv.s;
-    v = hsv.v;
-  }
+  constexpr color_qf(const color_qi& cqi) : color_qf(rgb_to_hsv(cqi)) { }
 
-  color_qf(const color e)
-  {
-    color_qi klr(e);
-    *this = color_qf(klr);
-  }
+  constexpr color_qf(const color e) : color_qf(color_qi(e)) { }
 
   static string
   to_string(color_qf s)
@@ -590,10 +611,10 @@ struct color_qf
   { return hsv_to_rgb({ h, s, v }); }
 
   /// Convert RGB to HSV
-  color_qf
-  rgb_to_hsv(const color_qi& rgb) const
+  static constexpr color_qf
+  rgb_to_hsv(const color_qi& rgb)
   {
-    color_qf hsv;
+    color_qf hsv(0, 0, 0);
 
     double r = rgb.r / 255.0;
     double g = rgb.g / 255.0;
@@ -610,7 +631,8 @@ struct color_qf
       }
     else if (max_val == r)
       {
-	hsv.h = 60.0 * fmod(((g - b) / delta), 6.0);
+	// NB: (g - b) / delta is in [-1, 1], so fmod(x, 6.0) == x.
+	hsv.h = 60.0 * ((g - b) / delta);
       }
     else if (max_val == g)
       {
@@ -693,26 +715,32 @@ struct color_qf
     // White is HSV(any, 0.0, 1.0)
     // const color_qf white_hsv = { h, 0.0, 1.0};
 
+    return hsv_to_rgb(tint_perceptual_hsv(*this, step));
+  }
+
+  /// HSV of tint_perceptual step n for base.
+  static constexpr color_qf
+  tint_perceptual_hsv(const color_qf& base, const uint step)
+  {
     // Use a custom interpolation curve
     // First increase value, then decrease saturation
-    color_qf result_hsv(*this);
+    color_qf result_hsv(base);
     if (step <= 4)
       {
 	// For steps 0-4, t is interpolate value: base.v → 1.0
 	double t = step / 4.0;
-	result_hsv.s = s; // Keep saturation
-	result_hsv.v = v + t * (1.0 - v);
+	result_hsv.s = base.s; // Keep saturation
+	result_hsv.v = base.v + t * (1.0 - base.v);
       }
     else
       {
 	// For steps 5-10, interpolate saturation: 1.0 → 0.3
 	double sat_t = (step - 4) / 6.0; // 0.0 to 1.0
 	double target_sat = 1.0 - 0.7 * sat_t; // 1.0 → 0.3
-	result_hsv.s = s * target_sat;
+	result_hsv.s = base.s * target_sat;
 	result_hsv.v = 1.0; // Max value
       }
-
-    return hsv_to_rgb(result_hsv);
+    return result_hsv;
   }
 
   /// Procedural tinting algorithm.
@@ -721,6 +749,14 @@ struct color_qf
   color_qi
   tint_percentage(const double tp,
 		  const double rmin = 0, const double rmax = 100)
+  {
+    return hsv_to_rgb(tint_percentage_hsv(*this, tp, rmin, rmax));
+  }
+
+  /// HSV of tint_percentage tp for base.
+  static constexpr color_qf
+  tint_percentage_hsv(const color_qf& base, const double tp,
+		      const double rmin = 0, const double rmax = 100)
   {
     double percentage = std::clamp(tp, rmin, rmax);
 
@@ -730,16 +766,15 @@ struct color_qf
     double saturationf = percentage / 100.0;
 
     // Alternative: Mix with white by reducing saturation and increasing value
-    color_qf result_hsv(*this);
+    color_qf result_hsv(base);
 
     // Reduce saturation based on tint percentage
     result_hsv.s *= saturationf;
 
     // Slightly increase value/brightness for tint effect
     // White has maximum brightness, so tinting moves toward value = 1.0
-    result_hsv.v = v + (1.0 - v) * (1.0 - saturationf) * 0.5;
-
-    return hsv_to_rgb(result_hsv);
+    result_hsv.v = base.v + (1.0 - base.v) * (1.0 - saturationf) * 0.5;
+    return result_hsv;
   }
 };
 
@@ -806,7 +841,7 @@ color_qf_lt_v(const color_qf& k1, const color_qf& k2)
 {
   using ftype = color_qf::ftype;
 
-  const color_qf originklr = color::black;
+  static constexpr color_qf originklr = color::black;
 
   // Compute distance from both arguments to compare color.
   ftype d1 = color_qf_distance(k1, originklr);
@@ -822,7 +857,7 @@ color_qf_lt(const color_qf& k1, const color_qf& k2)
 { return color_qf_lt_v(k1, k2); };
 
 
-inline bool
+constexpr bool
 operator==(const color_qf& c1, const color_qf& c2)
 {
   const bool t1 = c1.h == c2.h;
@@ -837,11 +872,12 @@ operator<(const color_qf& c1, const color_qf& c2)
 
 
 /// Return a variant on saturation/value only.
+/// Random values are drawn from rg.
+template<std::uniform_random_bit_generator _Rng>
 color_qf
-mutate_color_qf(const color_qf& k)
+mutate_color_qf(const color_qf& k, _Rng& rg)
 {
   color_qf ret(k);
-  static std::mt19937_64 rg(std::random_device{}());
   auto distr = std::uniform_real_distribution<>(0.5, 1);
 
   // saturation 0.5 to 1, aka more saturated.
@@ -858,6 +894,79 @@ mutate_color_qf(const color_qf& k)
 }
 
 
+/// Return a variant on saturation/value only.
+/// @param rindex random stream index
+color_qf
+mutate_color_qf(const color_qf& k, const uint64_t rindex = next_random_index())
+{
+  random_stream rg(rindex);
+  return mutate_color_qf(k, rg);
+}
+
+
+/**
+  Color quantified as CIE L*a*b* components, D65 white point.
+
+  L* is lightness between 0 and 100, a* and b* are signed opponent
+  axes. Euclidean distance between two values approximates
+  perceptual difference.
+*/
+struct color_lab
+{
+  using ftype = float;
+
+  ftype	l;
+  ftype	a;
+  ftype	b;
+};
+
+
+/// Convert sRGB to CIE L*a*b*.
+color_lab
+to_color_lab(const color_qi& k)
+{
+  // sRGB component to linear light.
+  auto linear = [](const double c)
+  {
+    const double cn = c / 255.0;
+    return cn <= 0.04045 ? cn / 12.92 : std::pow((cn + 0.055) / 1.055, 2.4);
+  };
+  const double r = linear(k.r);
+  const double g = linear(k.g);
+  const double b = linear(k.b);
+
+  // Linear sRGB to XYZ, normalized to D65 reference white.
+  const double x = (0.4124564 * r + 0.3575761 * g + 0.1804375 * b) / 0.95047;
+  const double y = (0.2126729 * r + 0.7151522 * g + 0.0721750 * b);
+  const double z = (0.0193339 * r + 0.1191920 * g + 0.9503041 * b) / 1.08883;
+
+  auto f = [](const double t)
+  {
+    constexpr double e = 216.0 / 24389.0;
+    constexpr double kappa = 24389.0 / 27.0;
+    return t > e ? std::cbrt(t) : (kappa * t + 16.0) / 116.0;
+  };
+  const double fx = f(x);
+  const double fy = f(y);
+  const double fz = f(z);
+
+  using ftype = color_lab::ftype;
+  return color_lab { ftype(116.0 * fy - 16.0), ftype(500.0 * (fx - fy)),
+		     ftype(200.0 * (fy - fz)) };
+}
+
+
+/// Squared Euclidean distance in CIE L*a*b*, aka CIE76 delta E squared.
+inline color_lab::ftype
+color_lab_distance2(const color_lab& k1, const color_lab& k2)
+{
+  const color_lab::ftype dl = k1.l - k2.l;
+  const color_lab::ftype da = k1.a - k2.a;
+  const color_lab::ftype db = k1.b - k2.b;
+  return dl * dl + da * da + db * db;
+}
+
+
 /**
   Combine color a with color b in percentages ad and ab, respectively.
 
@@ -893,6 +1002,132 @@ average_color_qi(const color_qi& a, const color_qi& b)
 /// Types for Color iteration and combinatorics.
 using color_qis = std::vector<color_qi>;
 using color_qfs = std::vector<color_qf>;
+using color_labs = std::vector<color_lab>;
+
+/// Polymorphic allocator variants, see svg::pmr::strings.
+namespace pmr {
+  using color_qis = std::pmr::vector<color_qi>;
+  using color_qfs = std::pmr::vector<color_qf>;
+  using color_labs = std::pmr::vector<color_lab>;
+} // namespace pmr
+
+
+/**
+   Batch RGB to HSV, out[i] = color_qf(in[i]).
+
+   Same arithmetic as color_qf::rgb_to_hsv, but the hue sector is
+   chosen with selects instead of branches so the loop vectorizes.
+*/
+void
+rgb_to_hsv(std::span<const color_qi> in, std::span<color_qf> out)
+{
+  using ftype = color_qf::ftype;
+  const size_t n = std::min(in.size(), out.size());
+  for (size_t i = 0; i < n; ++i)
+    {
+      const double r = in[i].r / 255.0;
+      const double g = in[i].g / 255.0;
+      const double b = in[i].b / 255.0;
+
+      const double max_val = std::max(r, std::max(g, b));
+      const double min_val = std::min(r, std::min(g, b));
+      const double delta = max_val - min_val;
+      const double d = delta == 0.0 ? 1.0 : delta;
+
+      const double hr = (g - b) / d;
+      const double hg = ((b - r) / d) + 2.0;
+      const double hb = ((r - g) / d) + 4.0;
+      double h = max_val == r ? hr : (max_val == g ? hg : hb);
+      h = delta == 0.0 ? 0.0 : 60.0 * h;
+
+      ftype hf = h;
+      hf = hf < 0.0 ? ftype(hf + 360.0) : hf;
+      out[i].h = hf;
+      out[i].s = max_val == 0.0 ? 0.0 : delta / (max_val == 0.0 ? 1.0 : max_val);
+      out[i].v = max_val;
+    }
+}
+
+
+/**
+   Batch HSV to RGB, out[i] = in[i].to_color_qi().
+
+   Same arithmetic as color_qf::hsv_to_rgb, with fmod replaced by its
+   exact trunc form and the hue sector chosen with selects.
+*/
+void
+hsv_to_rgb(std::span<const color_qf> in, std::span<color_qi> out)
+{
+  using itype = color_qi::itype;
+  const size_t n = std::min(in.size(), out.size());
+  for (size_t i = 0; i < n; ++i)
+    {
+      const double h = in[i].h;
+      const double c = in[i].v * in[i].s;
+      const double hp = h / 60.0;
+      const double fm = hp - 2.0 * std::trunc(hp / 2.0);
+      const double x = c * (1.0 - std::abs(fm - 1.0));
+      const double m = in[i].v - c;
+
+      // Sector 0-5, out of range hues are sector 5 as in hsv_to_rgb.
+      const bool inrangep = h >= 0.0 && h < 360.0;
+      const int sector = inrangep ? std::min(int(hp), 5) : 5;
+
+      const double rp = (sector == 0 || sector == 5) ? c
+	: (sector == 1 || sector == 4) ? x : 0.0;
+      const double gp = (sector == 1 || sector == 2) ? c
+	: (sector == 0 || sector == 3) ? x : 0.0;
+      const double bp = (sector == 3 || sector == 4) ? c
+	: (sector == 2 || sector == 5) ? x : 0.0;
+
+      out[i].r = static_cast<itype>(std::clamp((rp + m) * 255.0, 0.0, 255.0));
+      out[i].g = static_cast<itype>(std::clamp((gp + m) * 255.0, 0.0, 255.0));
+      out[i].b = static_cast<itype>(std::clamp((bp + m) * 255.0, 0.0, 255.0));
+    }
+}
+
+
+/// Batch tint ramps, steps 0 to 10 of tint_perceptual for each base
+/// color. Return has 11 colors per base, base after base.
+color_qis
+make_tint_ramps_perceptual(std::span<const color_qi> bases)
+{
+  constexpr uint steps = 11;
+  color_qfs basehsv(bases.size());
+  rgb_to_hsv(bases, basehsv);
+
+  color_qfs tints;
+  tints.reserve(bases.size() * steps);
+  for (const color_qf& base : basehsv)
+    for (uint i = 0; i < steps; ++i)
+      tints.push_back(color_qf::tint_perceptual_hsv(base, i));
+
+  color_qis ret(tints.size());
+  hsv_to_rgb(tints, ret);
+  return ret;
+}
+
+
+/// Batch tint ramps, tint_percentage for each percentage in tps for
+/// each base color. Return has tps.size() colors per base, base
+/// after base.
+color_qis
+make_tint_ramps_percentage(std::span<const color_qi> bases,
+			   std::span<const double> tps)
+{
+  color_qfs basehsv(bases.size());
+  rgb_to_hsv(bases, basehsv);
+
+  color_qfs tints;
+  tints.reserve(bases.size() * tps.size());
+  for (const color_qf& base : basehsv)
+    for (const double tp : tps)
+      tints.push_back(color_qf::tint_percentage_hsv(base, tp));
+
+  color_qis ret(tints.size());
+  hsv_to_rgb(tints, ret);
+  return ret;
+}
 
 } // namespace svg
 
@@ -192,7 +192,7 @@ element_to_svg_insert(const string isvgpre)
 /// etc.).
 ///
 /// See: https://developer.mozilla.org/en-US/docs/Web/SVG/Element/svg
-svg_element
+svg_element&
 insert_svg_at(svg_element& obj, const string isvg,
 	      const point_2t origin, const double origsize, const double isize,
 	      const double angled = 0, const style& styl = k::no_style)
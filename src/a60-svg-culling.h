@@ -0,0 +1,397 @@
+// svg viewport culling -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_CULLING_H
+#define MiL_SVG_CULLING_H 1
+
+#include <cctype>
+#include <charconv>
+
+
+namespace svg {
+
+/**
+   CULLING
+
+   Leaf elements (circle, rect, line, polyline, polygon, path, text)
+   keep a conservative bounding box of their geometry, computed as
+   their data is added, with their transform applied if it can be
+   parsed. Containers made while culling is on keep a viewport, the
+   visible region in their own coordinates. An element added to a
+   container with a viewport is dropped, before it is serialized, if
+   its box does not touch the viewport.
+
+   Elements are never dropped if their extent is not known: a
+   transform that cannot be parsed, filters, raw attributes, markers,
+   and text with markup. Containers with a transform stop culling,
+   since their children are in other coordinates.
+
+   Opt in with cull_scope, see a60-svg-elements.h.
+*/
+
+/// 2D affine transform as SVG matrix(a, b, c, d, e, f).
+struct affine
+{
+  double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+  /// This transform applied after t.
+  affine
+  operator*(const affine& t) const
+  {
+    return affine { a * t.a + c * t.b, b * t.a + d * t.b,
+		    a * t.c + c * t.d, b * t.c + d * t.d,
+		    a * t.e + c * t.f + e, b * t.e + d * t.f + f };
+  }
+
+  point_2t
+  operator()(const point_2t p) const
+  {
+    auto [ x, y ] = p;
+    return std::make_tuple(a * x + c * y + e, b * x + d * y + f);
+  }
+
+  static affine
+  translate(const double x, const double y)
+  { return affine { 1, 0, 0, 1, x, y }; }
+
+  static affine
+  scale(const double sx, const double sy)
+  { return affine { sx, 0, 0, sy, 0, 0 }; }
+
+  static affine
+  rotate(const double deg)
+  {
+    const double r = deg * k::pi / 180;
+    return affine { std::cos(r), std::sin(r), -std::sin(r), std::cos(r), 0, 0 };
+  }
+};
+
+
+/// Skip spaces and commas, then read a number from the front of s.
+/// Returns false if there is none.
+bool
+consume_number(string_view& s, double& d)
+{
+  const size_t start = s.find_first_not_of(" \t\n\r,");
+  if (start == string_view::npos)
+    return false;
+  s.remove_prefix(start);
+  if (s.front() == '+')
+    s.remove_prefix(1);
+
+  auto [ ptr, ec ] = std::from_chars(s.data(), s.data() + s.size(), d);
+  if (ec != std::errc())
+    return false;
+  s.remove_prefix(ptr - s.data());
+  return true;
+}
+
+
+/// Parse SVG transform attribute value s, as made by struct transform.
+/// Returns false for anything not understood.
+bool
+parse_transform(string_view s, affine& m)
+{
+  m = affine();
+  while (true)
+    {
+      const size_t nstart = s.find_first_not_of(" \t\n\r,");
+      if (nstart == string_view::npos)
+	return true;
+      s.remove_prefix(nstart);
+
+      const size_t open = s.find('(');
+      const size_t close = s.find(')');
+      if (open == string_view::npos || close == string_view::npos
+	  || close < open)
+	return false;
+
+      const string_view name = s.substr(0, s.find_first_of(" \t(", 0));
+      string_view args = s.substr(open + 1, close - open - 1);
+      s.remove_prefix(close + 1);
+
+      std::array<double, 6> v = { };
+      size_t n = 0;
+      for (double d; n < v.size() && consume_number(args, d); ++n)
+	v[n] = d;
+      if (args.find_first_not_of(" \t\n\r,") != string_view::npos)
+	return false;
+
+      if (name == "translate" && (n == 1 || n == 2))
+	m = m * affine::translate(v[0], v[1]);
+      else if (name == "scale" && (n == 1 || n == 2))
+	m = m * affine::scale(v[0], n == 2 ? v[1] : v[0]);
+      else if (name == "rotate" && n == 1)
+	m = m * affine::rotate(v[0]);
+      else if (name == "rotate" && n == 3)
+	m = m * affine::translate(v[1], v[2]) * affine::rotate(v[0])
+	  * affine::translate(-v[1], -v[2]);
+      else if (name == "skewX" && n == 1)
+	m = m * affine { 1, 0, std::tan(v[0] * k::pi / 180), 1, 0, 0 };
+      else if (name == "skewY" && n == 1)
+	m = m * affine { 1, std::tan(v[0] * k::pi / 180), 0, 1, 0, 0 };
+      else if (name == "matrix" && n == 6)
+	m = m * affine { v[0], v[1], v[2], v[3], v[4], v[5] };
+      else
+	return false;
+    }
+}
+
+
+/// Box holding b after transform s, or empty if s is not understood.
+bbox
+transform_bounds(const bbox& b, const string_view s)
+{
+  affine m;
+  if (b.emptyp() || !parse_transform(s, m))
+    return bbox();
+
+  bbox ret;
+  ret.extend(m({ b._M_x0, b._M_y0 }));
+  ret.extend(m({ b._M_x1, b._M_y0 }));
+  ret.extend(m({ b._M_x0, b._M_y1 }));
+  ret.extend(m({ b._M_x1, b._M_y1 }));
+  return ret;
+}
+
+
+/// Box of points.
+bbox
+points_bounds(const vrange& points)
+{
+  bbox ret;
+  for (const point_2t& p : points)
+    ret.extend(p);
+  return ret;
+}
+
+
+/**
+   Box holding the path with data d, or empty if d is not understood.
+
+   Curves are held by their control points, including the reflected
+   ones of S and T. Arcs are held by a box reaching twice their radius
+   from their start, as the arc lies on a circle through the start.
+*/
+bbox
+path_bounds(string_view d)
+{
+  bbox ret;
+  double x = 0, y = 0;		// Current point.
+  double sx = 0, sy = 0;	// Start of subpath.
+  double cx = 0, cy = 0;	// Last control point.
+  char cmd = 0;
+
+  auto flag = [&d](double& v)
+  {
+    const size_t start = d.find_first_not_of(" \t\n\r,");
+    if (start == string_view::npos || (d[start] != '0' && d[start] != '1'))
+      return false;
+    v = d[start] - '0';
+    d.remove_prefix(start + 1);
+    return true;
+  };
+
+  while (true)
+    {
+      const size_t start = d.find_first_not_of(" \t\n\r,");
+      if (start == string_view::npos)
+	return ret;
+      d.remove_prefix(start);
+
+      // Command, or repeat of the last one with implicit arguments.
+      if (std::isalpha(static_cast<unsigned char>(d.front())))
+	{
+	  cmd = d.front();
+	  d.remove_prefix(1);
+	}
+      else if (cmd == 0 || cmd == 'z' || cmd == 'Z')
+	return bbox();
+      else if (cmd == 'M')
+	cmd = 'L';
+      else if (cmd == 'm')
+	cmd = 'l';
+
+      const bool relp = std::islower(static_cast<unsigned char>(cmd));
+      const double ox = relp ? x : 0;
+      const double oy = relp ? y : 0;
+
+      // Read n numbers into v.
+      std::array<double, 7> v = { };
+      auto args = [&](const size_t n)
+      {
+	for (size_t i = 0; i < n; ++i)
+	  if (!consume_number(d, v[i]))
+	    return false;
+	return true;
+      };
+
+      // Add the n / 2 points in v, and move to the last.
+      auto points = [&](const size_t n)
+      {
+	for (size_t i = 0; i < n; i += 2)
+	  ret.extend({ ox + v[i], oy + v[i + 1] });
+	x = ox + v[n - 2];
+	y = oy + v[n - 1];
+      };
+
+      // Reflection of the last control point, for S and T.
+      const double rx = 2 * x - cx;
+      const double ry = 2 * y - cy;
+      const char ucmd = std::toupper(static_cast<unsigned char>(cmd));
+
+      switch (ucmd)
+	{
+	case 'M':
+	  if (!args(2))
+	    return bbox();
+	  points(2);
+	  sx = x;
+	  sy = y;
+	  break;
+	case 'L':
+	  if (!args(2))
+	    return bbox();
+	  points(2);
+	  break;
+	case 'T':
+	  if (!args(2))
+	    return bbox();
+	  ret.extend({ rx, ry });
+	  points(2);
+	  break;
+	case 'H':
+	  if (!args(1))
+	    return bbox();
+	  x = ox + v[0];
+	  ret.extend({ x, y });
+	  break;
+	case 'V':
+	  if (!args(1))
+	    return bbox();
+	  y = oy + v[0];
+	  ret.extend({ x, y });
+	  break;
+	case 'C':
+	  if (!args(6))
+	    return bbox();
+	  points(6);
+	  break;
+	case 'S':
+	  if (!args(4))
+	    return bbox();
+	  ret.extend({ rx, ry });
+	  points(4);
+	  break;
+	case 'Q':
+	  if (!args(4))
+	    return bbox();
+	  points(4);
+	  break;
+	case 'A':
+	  {
+	    if (!args(3) || !flag(v[3]) || !flag(v[4])
+		|| !consume_number(d, v[5]) || !consume_number(d, v[6]))
+	      return bbox();
+	    const double ex = ox + v[5];
+	    const double ey = oy + v[6];
+	    const double chord = std::hypot(ex - x, ey - y);
+	    const double r = std::max({ std::abs(v[0]), std::abs(v[1]),
+					chord / 2 });
+	    ret.extend(bbox::centered_at({ x, y }, 4 * r, 4 * r));
+	    ret.extend({ ex, ey });
+	    x = ex;
+	    y = ey;
+	    break;
+	  }
+	case 'Z':
+	  x = sx;
+	  y = sy;
+	  break;
+	default:
+	  return bbox();
+	}
+
+      // Last control point, or the current point after other commands.
+      if (ucmd == 'C' || ucmd == 'S')
+	{
+	  cx = ox + v[ucmd == 'C' ? 2 : 0];
+	  cy = oy + v[ucmd == 'C' ? 3 : 1];
+	}
+      else if (ucmd == 'Q')
+	{
+	  cx = ox + v[0];
+	  cy = oy + v[1];
+	}
+      else if (ucmd == 'T')
+	{
+	  cx = rx;
+	  cy = ry;
+	}
+      else
+	{
+	  cx = x;
+	  cy = y;
+	}
+    }
+}
+
+
+/**
+   Box holding text of n characters at p with font size, or empty if
+   unit is not a pixel or point.
+
+   Glyphs are taken as at most one em wide and the line as at most
+   two em from the baseline either way, around p for any anchor and
+   baseline.
+*/
+bbox
+text_bounds(const point_2t p, const size_t n, const space_type size,
+	    const unit u)
+{
+  double em = size;
+  if (u == unit::point || u == unit::pt)
+    em = size * 96 / 72;
+  else if (u != unit::pixel && u != unit::px)
+    return bbox();
+
+  const double w = n * em;
+  return bbox::centered_at(p, 2 * w, 4 * em);
+}
+
+
+/// Viewport for containers made from now on, in document coordinates,
+/// or empty for no culling. See cull_scope.
+bbox&
+get_cull_viewport()
+{
+  static bbox viewport;
+  return viewport;
+}
+
+
+/// Set viewport for culling, returning the old one.
+bbox
+set_cull_viewport(const bbox& b)
+{
+  bbox& active = get_cull_viewport();
+  const bbox old = active;
+  active = b;
+  return old;
+}
+
+} // namespace svg
+
+#endif
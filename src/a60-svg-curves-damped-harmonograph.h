@@ -24,6 +24,8 @@
 #include <tuple>
 #include <vector>
 
+#include "a60-svg-probes.h"
+
 using point_2t = std::tuple<double, double>;
 
 /**
@@ -58,6 +60,7 @@ generate_damped_harmonograph(point_2t pt, double r, double n, double d,
 
   // Calculate segments: more cycles require more steps to maintain smoothness
   int steps = static_cast<int>(cycles * 64);
+  MiL_SVG_PROBE2(curve__samples, "damped_harmonograph", steps);
   double max_t = cycles * 2.0 * std::numbers::pi;
   double dt = max_t / steps;
   double kappa = dt / 3.0;
@@ -121,6 +124,7 @@ generate_triple_harmonograph(point_2t origin, double r, double n1, double n2,
   };
 
   int steps = static_cast<int>(cycles * 120);
+  MiL_SVG_PROBE2(curve__samples, "triple_harmonograph", steps);
   double dt = (cycles * 2.0 * std::numbers::pi) / steps;
   double kappa = dt / 3.0;
 
@@ -455,6 +455,7 @@ append_polyline(std::string& path_data, const svg::vrange& points,
 {
   if (points.size() < (close ? 3U : 2U))
     return;
+  MiL_SVG_PROBE2(curve__samples, "hamonshu", points.size());
   path_data += svg::make_path_data_from_points(points);
   if (close)
     path_data += "Z ";
@@ -903,6 +904,7 @@ inline std::string
 make_motif_path(const pattern_spec& spec, const pattern_box& box,
                 const motif_config& config = {})
 {
+  svg::trace_scope ts("hamonshu::make_motif_path");
   validate_pattern_spec(spec);
   require(box.valid(), "Hamonshu motif box must be finite and positive");
   detail::validate_config(config);
@@ -124,6 +124,7 @@ path_from_points(const svg::vrange& points, const bool close)
 {
   require(points.size() >= 2,
           "roulette calculation produced too few path points");
+  MiL_SVG_PROBE2(curve__samples, "roulette", points.size());
   std::string path_data = svg::make_path_data_from_points(points);
   if (close)
     path_data += "Z ";
@@ -0,0 +1,454 @@
+// svg retained-mode document tree -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_DOCUMENT_TREE_H
+#define MiL_SVG_DOCUMENT_TREE_H 1
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <thread>
+
+
+namespace svg {
+
+/**
+   Retained-mode document tree.
+
+   Markup is kept as a tree of nodes over one text arena instead of
+   being concatenated as it is drawn. Each node is a span of the
+   arena, written first, followed by its children in order. Leaf
+   elements are text nodes holding their markup. Container elements
+   are nodes whose children are runs of their own markup (start and
+   finish tags, attributes) interleaved with the nodes of added
+   elements, one per element.
+
+   Nodes are five indices, children are linked first child to next
+   sibling, and adding a subtree from another tree appends its arena
+   and nodes in one step. Arena and nodes allocate from a memory
+   resource, by default the one current for the thread. Markup is serialized once, when the
+   document is written. The tree can be walked, reordered or pruned
+   before then.
+*/
+class document_tree
+{
+public:
+  using index_type = uint32_t;
+
+  static constexpr index_type	npos = std::numeric_limits<index_type>::max();
+
+  struct node
+  {
+    index_type	offset = 0;		///< Start of text span in arena.
+    index_type	length = 0;		///< Length of text span.
+    index_type	first_child = npos;
+    index_type	last_child = npos;
+    index_type	next_sibling = npos;
+  };
+
+private:
+  pmr::string			_M_text;
+  std::pmr::vector<node>	_M_nodes;
+
+  void
+  link_child(const index_type parent, const index_type child)
+  {
+    node& p = _M_nodes[parent];
+    if (p.last_child == npos)
+      p.first_child = child;
+    else
+      _M_nodes[p.last_child].next_sibling = child;
+    p.last_child = child;
+  }
+
+  /// Visit subtree at n in document order, calling f(node index).
+  template<typename _Fn>
+  void
+  walk(const index_type n, _Fn f) const
+  {
+    f(n);
+    std::vector<index_type> cursors(1, _M_nodes[n].first_child);
+    while (!cursors.empty())
+      {
+	const index_type i = cursors.back();
+	if (i == npos)
+	  {
+	    cursors.pop_back();
+	    continue;
+	  }
+	cursors.back() = _M_nodes[i].next_sibling;
+	f(i);
+	cursors.push_back(_M_nodes[i].first_child);
+      }
+  }
+
+public:
+  explicit
+  document_tree(std::pmr::memory_resource* mr = get_memory_resource())
+  : _M_text(mr), _M_nodes(1, mr) { }
+
+  /// Root node, an empty span holding the top level nodes.
+  static constexpr index_type
+  root()
+  { return 0; }
+
+  const node&
+  operator[](const index_type i) const
+  { return _M_nodes[i]; }
+
+  /// Number of nodes, including the root.
+  size_t
+  size() const
+  { return _M_nodes.size(); }
+
+  /// True if there is no text anywhere in the tree.
+  bool
+  empty() const
+  { return _M_text.empty(); }
+
+  /// Bytes of markup in the tree.
+  size_t
+  text_size() const
+  { return _M_text.size(); }
+
+  void
+  clear()
+  {
+    _M_text.clear();
+    _M_nodes.assign(1, node());
+  }
+
+  /// Text span of node i.
+  string_view
+  text(const index_type i) const
+  {
+    const node& nd = _M_nodes[i];
+    return string_view(_M_text).substr(nd.offset, nd.length);
+  }
+
+  /// Add text as last child of parent. If coalescep, text following
+  /// a text child that ends the arena extends that child instead of
+  /// adding a node.
+  index_type
+  add_text(const index_type parent, string_view s, const bool coalescep = true)
+  {
+    if (s.empty())
+      return npos;
+
+    const index_type last = _M_nodes[parent].last_child;
+    if (coalescep && last != npos)
+      {
+	node& nd = _M_nodes[last];
+	if (nd.first_child == npos && nd.offset + nd.length == _M_text.size())
+	  {
+	    _M_text.append(s);
+	    nd.length += s.size();
+	    return last;
+	  }
+      }
+
+    const index_type i = _M_nodes.size();
+    _M_nodes.push_back(node { index_type(_M_text.size()),
+			      index_type(s.size()), npos, npos, npos });
+    _M_text.append(s);
+    link_child(parent, i);
+    return i;
+  }
+
+  /// Add empty node as last child of parent, for nested content.
+  index_type
+  add_node(const index_type parent)
+  {
+    const index_type i = _M_nodes.size();
+    _M_nodes.push_back(node { index_type(_M_text.size()), 0, npos, npos, npos });
+    link_child(parent, i);
+    return i;
+  }
+
+  /// Add a copy of all of other as last child of parent.
+  /// Returns the node for the root of other.
+  index_type
+  splice(const index_type parent, const document_tree& other)
+  {
+    const index_type textbase = _M_text.size();
+    const index_type nodebase = _M_nodes.size();
+    auto rebase = [nodebase](const index_type i)
+    { return i == npos ? npos : i + nodebase; };
+
+    _M_text.append(other._M_text);
+    _M_nodes.reserve(_M_nodes.size() + other._M_nodes.size());
+    for (const node& nd : other._M_nodes)
+      _M_nodes.push_back(node { nd.offset + textbase, nd.length,
+				rebase(nd.first_child),
+				rebase(nd.last_child),
+				rebase(nd.next_sibling) });
+    link_child(parent, nodebase);
+    return nodebase;
+  }
+
+  /// Append markup of subtree at n to out.
+  void
+  append_to(string& out, const index_type n = root()) const
+  {
+    if (n == root())
+      out.reserve(out.size() + _M_text.size());
+    walk(n, [&](const index_type i)
+	 { out.append(_M_text.data() + _M_nodes[i].offset, _M_nodes[i].length); });
+  }
+
+  /// Write markup of subtree at n to os.
+  void
+  write(std::ostream& os, const index_type n = root()) const
+  {
+    walk(n, [&](const index_type i)
+	 { os.write(_M_text.data() + _M_nodes[i].offset, _M_nodes[i].length); });
+  }
+
+  /// Markup of subtree at n.
+  string
+  str(const index_type n = root()) const
+  {
+    string ret;
+    append_to(ret, n);
+    return ret;
+  }
+
+  /// Bytes of markup in subtree at n.
+  size_t
+  subtree_size(const index_type n) const
+  {
+    size_t ret = 0;
+    walk(n, [&](const index_type i) { ret += _M_nodes[i].length; });
+    return ret;
+  }
+
+  /// Copy markup of subtree at n to out, which has room for
+  /// subtree_size(n) chars. Returns end of output.
+  char*
+  copy_to(char* out, const index_type n) const
+  {
+    walk(n, [&](const index_type i)
+	 {
+	   const node& nd = _M_nodes[i];
+	   std::memcpy(out, _M_text.data() + nd.offset, nd.length);
+	   out += nd.length;
+	 });
+    return out;
+  }
+
+  /**
+     Piece of the document, in document order: either a node with all
+     its children (deepp), or only the text of the node itself.
+  */
+  struct segment
+  {
+    index_type	node;
+    bool	deepp;
+    size_t	size;
+    size_t	offset;		///< Start in serialized output.
+  };
+
+  /**
+     Split the document into segments in document order, each at most
+     about maxsize bytes. Nodes larger than that are opened up into
+     their own text and their children, so that one big top-level
+     group does not end up as one segment.
+  */
+  std::vector<segment>
+  segments(const size_t maxsize) const
+  {
+    std::vector<segment> ret;
+    size_t offset = 0;
+    auto add = [&](const index_type i, const bool deepp, const size_t sz)
+    {
+      if (sz)
+	ret.push_back(segment { i, deepp, sz, offset });
+      offset += sz;
+    };
+
+    // Depth first, opening nodes larger than maxsize.
+    std::vector<index_type> cursors(1, root());
+    add(root(), false, _M_nodes[root()].length);
+    cursors.back() = _M_nodes[root()].first_child;
+    while (!cursors.empty())
+      {
+	const index_type i = cursors.back();
+	if (i == npos)
+	  {
+	    cursors.pop_back();
+	    continue;
+	  }
+	cursors.back() = _M_nodes[i].next_sibling;
+
+	const size_t sz = subtree_size(i);
+	if (sz > maxsize && _M_nodes[i].first_child != npos)
+	  {
+	    add(i, false, _M_nodes[i].length);
+	    cursors.push_back(_M_nodes[i].first_child);
+	  }
+	else
+	  add(i, true, sz);
+      }
+    return ret;
+  }
+
+  /// Copy markup of segment to out, which has room for it.
+  void
+  copy_segment_to(char* out, const segment& seg) const
+  {
+    if (seg.deepp)
+      copy_to(out, seg.node);
+    else
+      std::memcpy(out, _M_text.data() + _M_nodes[seg.node].offset,
+		  _M_nodes[seg.node].length);
+  }
+};
+
+
+/**
+   Run task(i) for each i in [0, ntasks), in any order and on any
+   threads, returning when all are done.
+
+   Serialization calls this with independent tasks that each write a
+   disjoint part of one output buffer, see serialize_parallel.
+*/
+using task_executor = std::function<void(const size_t ntasks,
+			const std::function<void(size_t)>& task)>;
+
+
+/// Executor running tasks on nthreads std::threads, or on one thread
+/// per hardware core if nthreads is zero.
+task_executor
+make_thread_executor(uint nthreads = 0)
+{
+  if (nthreads == 0)
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+
+  return [nthreads](const size_t ntasks,
+		    const std::function<void(size_t)>& task)
+  {
+    std::atomic<size_t> next(0);
+    auto work = [&]()
+    {
+      for (size_t i = next++; i < ntasks; i = next++)
+	task(i);
+    };
+
+    const size_t nworkers = std::min(size_t(nthreads), ntasks);
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < nworkers; ++w)
+      workers.emplace_back(work);
+    work();
+    for (std::thread& t : workers)
+      t.join();
+  };
+}
+
+
+/// Executor used to serialize retained documents. Empty, the default,
+/// means serialize on the calling thread.
+task_executor&
+get_serialize_executor()
+{
+  static task_executor ex;
+  return ex;
+}
+
+
+/// Set executor for serialization, returning the old one.
+task_executor
+set_serialize_executor(task_executor ex)
+{
+  task_executor& active = get_serialize_executor();
+  task_executor old = std::move(active);
+  active = std::move(ex);
+  return old;
+}
+
+
+/**
+   Serialize tree with ex, into out.
+
+   Independent subtrees, usually the top-level groups, are copied
+   concurrently straight into their place in one output buffer, sized
+   from the tree in advance, so output is byte-identical to the serial
+   path. Falls back to serial if ex is empty or there is only one
+   task worth of markup.
+
+   @param tasksize aim for tasks of about this many bytes.
+*/
+void
+serialize_parallel(const document_tree& tree, string& out,
+		   const task_executor& ex = get_serialize_executor(),
+		   const size_t tasksize = 256 * 1024)
+{
+  if (!ex || tree.text_size() <= tasksize)
+    {
+      tree.append_to(out);
+      return;
+    }
+
+  // Group consecutive segments into tasks of about tasksize bytes.
+  const auto segs = tree.segments(tasksize);
+  std::vector<size_t> starts;
+  size_t acc = tasksize;
+  for (size_t i = 0; i < segs.size(); ++i)
+    {
+      if (acc >= tasksize)
+	{
+	  starts.push_back(i);
+	  acc = 0;
+	}
+      acc += segs[i].size;
+    }
+  starts.push_back(segs.size());
+
+  const size_t base = out.size();
+  out.resize(base + tree.text_size());
+  char* dest = out.data() + base;
+  ex(starts.size() - 1, [&](const size_t t)
+     {
+       for (size_t i = starts[t]; i < starts[t + 1]; ++i)
+	 tree.copy_segment_to(dest + segs[i].offset, segs[i]);
+     });
+}
+
+
+/// Build svg_element and group_element as document trees, see
+/// element_base::retain. Off by default.
+bool&
+get_retained_mode()
+{
+  static bool retainedp(false);
+  return retainedp;
+}
+
+
+/// Set retained mode for new documents and groups, returning old value.
+bool
+set_retained_mode(const bool retainedp)
+{
+  bool& active = get_retained_mode();
+  const bool old = active;
+  active = retainedp;
+  return old;
+}
+
+} // namespace svg
+
+#endif
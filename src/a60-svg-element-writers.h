@@ -0,0 +1,350 @@
+// svg element writers -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_ELEMENT_WRITERS_H
+#define MiL_SVG_ELEMENT_WRITERS_H 1
+
+#include <charconv>
+#include <type_traits>
+
+
+namespace svg {
+
+/**
+   Number text as written by std::to_string(double), "%f".
+*/
+void
+append_fixed(string& out, const double d)
+{
+  char buf[512];
+  auto [ ptr, ec ] = std::to_chars(buf, buf + sizeof(buf), d,
+				   std::chars_format::fixed, 6);
+  out.append(buf, ptr - buf);
+}
+
+
+/**
+   Number text as written by an ostream with precision, "%g".
+   Default precision 6 is the ostream default.
+*/
+void
+append_general(string& out, const double d, const int precision = 6)
+{
+  char buf[64];
+  auto [ ptr, ec ] = std::to_chars(buf, buf + sizeof(buf), d,
+				   std::chars_format::general, precision);
+  out.append(buf, ptr - buf);
+}
+
+
+/// Style attribute, as to_string(const style&).
+void
+append_style(string& out, const style& s)
+{
+  const string_view space("; ");
+  out += k::space;
+  out += "style=";
+  out += k::quote;
+  out += "fill:";
+  out += color_qi::to_string(s._M_fill_color);
+  out += space;
+  out += "fill-opacity:";
+  append_general(out, s._M_fill_opacity);
+  out += space;
+  out += "stroke:";
+  out += color_qi::to_string(s._M_stroke_color);
+  out += space;
+  out += "stroke-opacity:";
+  append_general(out, s._M_stroke_opacity);
+  out += space;
+  out += "stroke-width:";
+  append_general(out, s._M_stroke_size);
+  out += k::quote;
+}
+
+
+/// Attribute name="value".
+void
+append_attribute(string& out, const string_view name, const string_view value)
+{
+  out += name;
+  out += '=';
+  out += k::quote;
+  out += value;
+  out += k::quote;
+}
+
+
+/**
+   Element writers.
+
+   Serialize one element straight into a caller supplied string,
+   without an element object. Writers are one pointer, have no
+   virtual functions, and allocate only when the output grows. The
+   element classes in a60-svg-elements.h use them for their data and
+   stay as the general, composable interface.
+
+   Output is the same as the matching element class.
+
+   Use as:
+   string out;
+   circle_writer c(out);
+   c.start();
+   c.add_data(x, y, r);
+   c.add_style(s);
+   c.finish();
+   obj.add_markup(out);
+
+   Each writer derives from element_writer<writer>, and provides
+   tag, the element name, and finish_tag, the markup closing it.
+*/
+template<typename _Derived>
+struct element_writer
+{
+  string*	_M_out;
+
+  explicit
+  element_writer(string& out) : _M_out(&out) { }
+
+  string&
+  out() { return *_M_out; }
+
+  void
+  start()
+  {
+    out() += '<';
+    out() += _Derived::tag;
+    out() += k::space;
+  }
+
+  void
+  start(const string_view id)
+  {
+    out() += '<';
+    out() += _Derived::tag;
+    out() += " id=";
+    out() += k::quote;
+    out() += id;
+    out() += k::quote;
+    out() += k::space;
+  }
+
+  void
+  finish()
+  { out() += _Derived::finish_tag; }
+
+  void
+  add_style(const style& sty)
+  { append_style(out(), sty); }
+
+  void
+  add_transform(const string_view s)
+  {
+    if (!s.empty())
+      {
+	out() += k::space;
+	append_attribute(out(), "transform", s);
+      }
+  }
+
+  void
+  add_fill(const string_view id)
+  {
+    out() += k::space;
+    out() += "fill=";
+    out() += k::quote;
+    out() += "url(#";
+    out() += id;
+    out() += ")";
+    out() += k::quote;
+  }
+
+  void
+  add_filter(const string_view id)
+  {
+    out() += k::space;
+    out() += "filter=";
+    out() += k::quote;
+    out() += "url(#";
+    out() += id;
+    out() += ")";
+    out() += k::quote;
+  }
+
+  void
+  add_raw(const string_view raw)
+  {
+    out() += k::space;
+    out() += raw;
+  }
+};
+
+
+/// Circle, as circle_element.
+struct circle_writer : public element_writer<circle_writer>
+{
+  static constexpr const char*	tag = "circle";
+  static constexpr const char*	finish_tag = " />\n";
+
+  using element_writer::element_writer;
+
+  void
+  add_data(const double x, const double y, const double r)
+  {
+    out() += "cx=\"";
+    append_fixed(out(), x);
+    out() += "\" cy=\"";
+    append_fixed(out(), y);
+    out() += "\" r=\"";
+    append_fixed(out(), r);
+    out() += k::quote;
+  }
+};
+
+
+/// Rectangle, as rect_element.
+struct rect_writer : public element_writer<rect_writer>
+{
+  static constexpr const char*	tag = "rect";
+  static constexpr const char*	finish_tag = " />\n";
+
+  using element_writer::element_writer;
+
+  void
+  add_data(const double x, const double y, const double w, const double h)
+  {
+    out() += "x=\"";
+    append_fixed(out(), x);
+    out() += "\" y=\"";
+    append_fixed(out(), y);
+    out() += "\" width=\"";
+    append_fixed(out(), w);
+    out() += "\" height=\"";
+    append_fixed(out(), h);
+    out() += k::quote;
+    out() += k::newline;
+  }
+};
+
+
+/// Line, as line_element.
+struct line_writer : public element_writer<line_writer>
+{
+  static constexpr const char*	tag = "line";
+  static constexpr const char*	finish_tag = " />\n";
+
+  using element_writer::element_writer;
+
+  void
+  add_data(const double x1, const double y1, const double x2, const double y2,
+	   const string_view dasharray = "")
+  {
+    out() += "x1=\"";
+    append_fixed(out(), x1);
+    out() += "\" y1=\"";
+    append_fixed(out(), y1);
+    out() += "\" x2=\"";
+    append_fixed(out(), x2);
+    out() += "\" y2=\"";
+    append_fixed(out(), y2);
+    out() += k::quote;
+    if (!dasharray.empty())
+      {
+	out() += k::space;
+	append_attribute(out(), "stroke-dasharray", dasharray);
+      }
+  }
+};
+
+
+/// Polygon, as polygon_element, with two significant digits.
+struct polygon_writer : public element_writer<polygon_writer>
+{
+  static constexpr const char*	tag = "polygon";
+  static constexpr const char*	finish_tag = " />";
+
+  using element_writer::element_writer;
+
+  void
+  add_data(const vrange& points)
+  {
+    out() += "points=";
+    out() += k::quote;
+    for (const auto& [ x, y ]: points)
+      {
+	append_general(out(), x, 2);
+	out() += k::comma;
+	append_general(out(), y, 2);
+	out() += k::space;
+      }
+    out() += k::quote;
+    out() += k::newline;
+  }
+};
+
+
+/// Polyline, as polyline_element.
+struct polyline_writer : public element_writer<polyline_writer>
+{
+  static constexpr const char*	tag = "polyline";
+  static constexpr const char*	finish_tag = " />\n";
+
+  using element_writer::element_writer;
+
+  void
+  add_data(const vrange& points, const stroke_style& sstyl)
+  {
+    if (points.empty())
+      return;
+
+    out() += "points=";
+    out() += k::quote;
+    for (const auto& [ x, y ]: points)
+      {
+	append_general(out(), x);
+	out() += k::comma;
+	append_general(out(), y);
+	out() += k::space;
+      }
+    out() += k::quote;
+    out() += k::space;
+
+    auto add_stroke = [this](const string_view name, const string_view value)
+    {
+      if (!value.empty())
+	{
+	  append_attribute(out(), name, value);
+	  out() += k::space;
+	}
+    };
+    add_stroke("stroke-dasharray", sstyl.dasharray);
+    add_stroke("stroke-dashoffset", sstyl.dashoffset);
+    add_stroke("stroke-linecap", sstyl.linecap);
+    if (!sstyl.marker_defs.empty())
+      {
+	const string mkr = "url(#" + sstyl.marker_defs + ")";
+	add_stroke("marker-mid", mkr);
+	add_stroke("marker-end", mkr);
+      }
+  }
+};
+
+
+static_assert(std::is_trivially_copyable_v<circle_writer>);
+static_assert(std::is_trivially_destructible_v<polyline_writer>);
+
+} // namespace svg
+
+#endif
@@ -31,13 +31,31 @@ element_base::add_title(const string& t)
 void
 svg_element::write()
 {
+  trace_scope ts("svg_element::write");
   try
     {
       string filename(_M_name + ".svg");
+      MiL_SVG_PROBE1(write__begin, filename.c_str());
+      probe_timer pt;
       std::ofstream f(filename);
       if (!f.is_open() || !f.good())
 	throw std::runtime_error("svg_element::write fail");
-      f << _M_sstream.str() << std::endl;
+      if (render_stats* rs = get_render_stats())
+	{
+	  string s;
+	  {
+	    render_stage_timer t(render_stage::serialize);
+	    s = str();
+	  }
+	  render_stage_timer t(render_stage::write);
+	  f << s;
+	  rs->document_bytes += s.size();
+	}
+      else
+	write_to(f);
+      f << std::endl;
+      MiL_SVG_PROBE3(write__end, filename.c_str(), uint64_t(f.tellp()),
+		     pt.elapsed_ns());
     }
   catch(std::exception& e)
     {
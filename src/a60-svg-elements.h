@@ -30,7 +30,11 @@ namespace svg {
 /// Abstract base class for all SVG Elements.
 struct element_base
 {
-  using stream_type = std::ostringstream;
+  /// Output buffer allocating from a memory resource, see
+  /// get_memory_resource.
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+  using stream_type = std::basic_ostringstream<char, std::char_traits<char>,
+					       allocator_type>;
   static constexpr const char*	finish_tag = " >";
   static constexpr string	finish_tag_hard = string(finish_tag) + k::newline;
   static constexpr const char*	self_finish_tag = " />";
@@ -42,21 +46,140 @@ struct element_base
   /// Virtual, only one buffer.
   stream_type		_M_sstream;
 
+  /// Optional retained-mode tree, see retain. When set, content is
+  /// the tree followed by any output in _M_sstream not yet moved to
+  /// the tree.
+  std::unique_ptr<document_tree>	_M_tree;
+
+  /// Culling, see a60-svg-culling.h. Box of the geometry of this
+  /// element in the coordinates of its parent, empty if not known.
+  bbox			_M_bounds;
+
+  /// True once content of unknown extent is added, as a filter.
+  bool			_M_unboundedp = false;
+
+  /// Visible region in the coordinates of this element. Added
+  /// elements outside it are dropped. Empty if not culling.
+  bbox			_M_viewport;
+
+  /// Widest stroke of added styles, to grow boxes by.
+  space_type		_M_stroke_width = 0;
+
+  element_base()
+  : _M_sstream(std::ios_base::out, allocator_type(get_memory_resource())),
+    _M_viewport(get_cull_viewport())
+  { }
+
   virtual void
   start_element() = 0;
 
   virtual void
   finish_element() = 0;
 
+  /// Keep content as a document_tree instead of one buffer. Added
+  /// elements become nodes of the tree, and are serialized once, when
+  /// written.
+  void
+  retain()
+  {
+    if (!_M_tree)
+      {
+	_M_tree = std::make_unique<document_tree>(get_memory_resource());
+	flush_to_tree();
+      }
+  }
+
+  bool
+  retainedp() const { return bool(_M_tree); }
+
+  /// Bytes of content.
+  size_t
+  size() const
+  { return (_M_tree ? _M_tree->text_size() : 0) + _M_sstream.view().size(); }
+
+  /// Extend box of geometry by b.
+  void
+  add_bounds(const bbox& b)
+  {
+    if (!_M_unboundedp)
+      _M_bounds.extend(b);
+  }
+
+  /// Extent is no longer known, so never cull this element.
+  void
+  unbound()
+  {
+    _M_unboundedp = true;
+    _M_bounds = bbox();
+  }
+
+  /// True if geometry in box b, with strokes of width stroke, cannot
+  /// be seen in the viewport. Strokes are taken as reaching twice
+  /// their width, for miter joins and caps.
+  bool
+  culledp(const bbox& b, const space_type stroke = 0) const
+  {
+    if (_M_viewport.emptyp() || b.emptyp())
+      return false;
+    const bbox visible = _M_viewport.inflate(2 * _M_stroke_width);
+    return !visible.intersectsp(b.inflate(2 * stroke));
+  }
+
+  bool
+  culledp(const element_base& e) const
+  { return !e._M_unboundedp && culledp(e._M_bounds, e._M_stroke_width); }
+
+  /// Move pending output in _M_sstream to the tree.
+  void
+  flush_to_tree()
+  {
+    if (_M_tree && !_M_sstream.view().empty())
+      {
+	_M_tree->add_text(document_tree::root(), _M_sstream.view());
+	_M_sstream.str("");
+      }
+  }
+
   /// Empty when the output buffer is.
   bool
-  empty() { return _M_sstream.str().empty(); }
+  empty() const
+  { return _M_sstream.view().empty() && (!_M_tree || _M_tree->empty()); }
 
   string
-  str() const { return _M_sstream.str(); }
+  str() const
+  {
+    if (!_M_tree)
+      return string(_M_sstream.view());
+
+    string ret;
+    serialize_parallel(*_M_tree, ret);
+    ret.append(_M_sstream.view());
+    return ret;
+  }
 
   void
-  str(const string& s) { return _M_sstream.str(s); }
+  str(const string& s)
+  {
+    if (_M_tree)
+      _M_tree->clear();
+    _M_sstream.str(pmr::string(s, _M_sstream.rdbuf()->get_allocator()));
+  }
+
+  /// Write content to os, without making a string first unless
+  /// serializing in parallel, see set_serialize_executor.
+  void
+  write_to(std::ostream& os) const
+  {
+    if (_M_tree && get_serialize_executor())
+      {
+	string s;
+	serialize_parallel(*_M_tree, s);
+	os << s;
+      }
+    else if (_M_tree)
+      _M_tree->write(os);
+    os << _M_sstream.view();
+  }
 
   // Add sub element e to base object in non-visible defs section
   void
@@ -65,7 +188,53 @@ struct element_base
   // Add sub element e to base object
   void
   add_element(const element_base& e)
-  { _M_sstream << e.str(); }
+  {
+    if (culledp(e))
+      {
+	if (render_stats* rs = get_render_stats())
+	  ++rs->culled;
+	return;
+      }
+
+    MiL_SVG_PROBE2(element__add, e._M_sstream.view().data(), e.size());
+    if (render_stats* rs = get_render_stats())
+      {
+	if (e._M_tree)
+	  rs->add_element(e.str());
+	else
+	  rs->add_element(e._M_sstream.view());
+      }
+
+    if (_M_tree)
+      {
+	flush_to_tree();
+	document_tree::index_type n = document_tree::root();
+	if (e._M_tree)
+	  n = _M_tree->splice(n, *e._M_tree);
+	_M_tree->add_text(n, e._M_sstream.view(), false);
+      }
+    else
+      e.write_to(_M_sstream);
+  }
+
+  // Add sub element e to base object, taking its buffers if nothing
+  // has been added yet.
+  void
+  add_element(element_base&& e)
+  {
+    if (!empty() || bool(_M_tree) != bool(e._M_tree) || culledp(e))
+      {
+	add_element(e);
+	return;
+      }
+
+    if (render_stats* rs = get_render_stats())
+      rs->add_element(e.str());
+
+    _M_tree = std::move(e._M_tree);
+    _M_sstream.str(std::move(e._M_sstream).str());
+    _M_sstream.seekp(0, std::ios_base::end);
+  }
 
   void
   add_fill(const string id)
@@ -78,19 +247,54 @@ struct element_base
   void
   add_filter(const string id)
   {
+    unbound();
     _M_sstream << k::space;
     _M_sstream << "filter=" << k::quote;
     _M_sstream << "url(#" << id << ")" << k::quote;
   }
 
   // Add raw string to group; filter, blend/gradient elements.
+  // Attributes may change extent or coordinates, so stop culling.
   void
   add_raw(const string& raw)
-  { _M_sstream << k::space << raw; }
+  {
+    if (raw.find('=') != string::npos)
+      {
+	unbound();
+	if (raw.find("transform") != string::npos)
+	  _M_viewport = bbox();
+      }
+    _M_sstream << k::space << raw;
+  }
 
   void
   add_style(const style& sty)
-  { _M_sstream << to_string(sty); }
+  {
+    _M_stroke_width = std::max(_M_stroke_width, space_type(sty._M_stroke_size));
+    _M_sstream << to_string(sty);
+  }
+
+  /// Add serialized markup, as from an element writer.
+  void
+  add_markup(const string_view s)
+  {
+    if (render_stats* rs = get_render_stats())
+      rs->add_markup(s);
+    _M_sstream << s;
+  }
+
+  /// Add serialized markup of an element with box b, unless culled.
+  void
+  add_markup(const string_view s, const bbox& b, const space_type stroke = 0)
+  {
+    if (culledp(b, stroke))
+      {
+	if (render_stats* rs = get_render_stats())
+	  ++rs->culled;
+	return;
+      }
+    add_markup(s);
+  }
 
   void
   add_title(const string& t);
@@ -104,11 +308,19 @@ struct element_base
     return oss.str();
   }
 
+  /// Transform the box of geometry added so far. Children of this
+  /// element are then in other coordinates, so stop culling them.
   void
   add_transform(const string s)
   {
     if (!s.empty())
-      _M_sstream << make_transform_attribute(s);
+      {
+	_M_bounds = transform_bounds(_M_bounds, s);
+	if (_M_bounds.emptyp())
+	  unbound();
+	_M_viewport = bbox();
+	_M_sstream << make_transform_attribute(s);
+      }
   }
 };
 
@@ -124,6 +336,12 @@ struct element_base
  */
 struct group_element : virtual public element_base
 {
+  group_element()
+  {
+    if (get_retained_mode())
+      retain();
+  }
+
   static string
   start_group(const string name)
   {
@@ -226,7 +444,7 @@ void
 element_base::store_element(const element_base& e)
 {
   _M_sstream << defs_element::start_defs();
-  _M_sstream << e.str();
+  add_element(e);
   _M_sstream << defs_element::finish_defs();
 }
 
@@ -348,7 +566,7 @@ struct filter_element : virtual public element_base
     stream << k::quote << in << k::quote << k::space;
     stream <<  "stdDeviation=" << k::quote << dev << k::quote << k::space;
     stream <<  "/>";
-    return stream.str();
+    return string(stream.view());
   }
 
   string
@@ -643,6 +861,9 @@ struct text_element : virtual public element_base
     string_replace(strip, attr, d._M_typo.add_attribute(utype));
     string_replace(strip, style, to_string(d._M_typo._M_style));
     _M_sstream << strip;
+    if (d._M_text.find('<') == string::npos)
+      add_bounds(text_bounds({ d._M_x_origin, d._M_y_origin },
+			     d._M_text.size(), d._M_typo._M_size, utype));
     add_transform(trans);
     _M_sstream << '>';
 
@@ -755,19 +976,12 @@ struct rect_element : virtual public element_base
   void
   add_data(const data& d)
   {
-    const string x("__x");
-    const string y("__y");
-    const string w("__w");
-    const string h("__h");
-
-    string strip = R"_delimiter_(x="__x" y="__y" width="__w" height="__h"
-)_delimiter_";
-
-    string_replace(strip, x, std::to_string(d._M_x_origin));
-    string_replace(strip, y, std::to_string(d._M_y_origin));
-    string_replace(strip, w, std::to_string(d._M_width));
-    string_replace(strip, h, std::to_string(d._M_height));
+    string strip;
+    rect_writer(strip).add_data(d._M_x_origin, d._M_y_origin,
+				d._M_width, d._M_height);
     _M_sstream << strip;
+    add_bounds(bbox(d._M_x_origin, d._M_y_origin,
+		    d._M_x_origin + d._M_width, d._M_y_origin + d._M_height));
   }
 
   void
@@ -811,16 +1025,12 @@ struct circle_element : virtual public element_base
   void
   add_data(const data& d, string trans = "")
   {
-    const string x("__x");
-    const string y("__y");
-    const string r("__r");
-
-    string strip = R"_delimiter_(cx="__x" cy="__y" r="__r")_delimiter_";
-
-    string_replace(strip, x, std::to_string(d._M_x_origin));
-    string_replace(strip, y, std::to_string(d._M_y_origin));
-    string_replace(strip, r, std::to_string(d._M_radius));
+    string strip;
+    circle_writer(strip).add_data(d._M_x_origin, d._M_y_origin, d._M_radius);
     _M_sstream << strip;
+    const atype diameter = 2 * d._M_radius;
+    add_bounds(bbox::centered_at({ d._M_x_origin, d._M_y_origin },
+				 diameter, diameter));
     add_transform(trans);
   }
 
@@ -861,11 +1071,11 @@ struct polygon_element : virtual public element_base
   void
   add_data(const vrange& points)
   {
-    _M_sstream << "points=" << k::quote;
+    string strip;
+    polygon_writer(strip).add_data(points);
+    _M_sstream << strip;
+    add_bounds(points_bounds(points));
     _M_sstream << std::setprecision(2);
-    for (const auto& [ x, y ]: points)
-      _M_sstream << x << k::comma << y << k::space;
-    _M_sstream << k::quote << k::newline;
   }
 
   void
@@ -902,27 +1112,14 @@ struct line_element : virtual public element_base
   void
   add_data(const data& d, const string dasharray = "")
   {
-    const string x1("__x1");
-    const string x2("__x2");
-    const string y1("__y1");
-    const string y2("__y2");
-    const string dash("__darray");
-
-    const bool dashp = !dasharray.empty();
-    string stripf = \
-    R"_delimiter_(x1="__x1" y1="__y1" x2="__x2" y2="__y2")_delimiter_";
-    string stript = \
-    R"_delimiter_(x1="__x1" y1="__y1" x2="__x2" y2="__y2" stroke-dasharray="__darray")_delimiter_";
-
-    string strip = dashp ? stript : stripf;
-    string_replace(strip, x1, std::to_string(d._M_x_begin));
-    string_replace(strip, x2, std::to_string(d._M_x_end));
-    string_replace(strip, y1, std::to_string(d._M_y_begin));
-    string_replace(strip, y2, std::to_string(d._M_y_end));
-
-    if (dashp)
-      string_replace(strip, dash, dasharray);
+    string strip;
+    line_writer(strip).add_data(d._M_x_begin, d._M_y_begin,
+				d._M_x_end, d._M_y_end, dasharray);
     _M_sstream << strip;
+    add_bounds(bbox(std::min(d._M_x_begin, d._M_x_end),
+		    std::min(d._M_y_begin, d._M_y_end),
+		    std::max(d._M_x_begin, d._M_x_end),
+		    std::max(d._M_y_begin, d._M_y_end)));
   }
 
   void
@@ -965,45 +1162,15 @@ struct polyline_element : virtual public element_base
   void
   add_data(const stroke_style& sstyl)
   {
-    if (!polypoints.empty())
-      {
-	_M_sstream << "points=" << k::quote;
-	for (const point_2t& pt : polypoints)
-	  {
-	    auto [ x, y ] = pt;
-	    _M_sstream << x << k::comma << y << k::space;
-	  }
-	_M_sstream << k::quote << k::space;
-
-	if (!sstyl.dasharray.empty())
-	  {
-	    _M_sstream << "stroke-dasharray=" << k::quote;
-	    _M_sstream << sstyl.dasharray << k::quote << k::space;
-	  }
-	if (!sstyl.dashoffset.empty())
-	  {
-	    _M_sstream << "stroke-dashoffset=" << k::quote;
-	    _M_sstream << sstyl.dashoffset << k::quote << k::space;
-	  }
-	if (!sstyl.linecap.empty())
-	  {
-	    _M_sstream << "stroke-linecap=" << k::quote;
-	    _M_sstream << sstyl.linecap << k::quote << k::space;
-	  }
-	if (!sstyl.marker_defs.empty())
-	  {
-	    // line_style 3
-	    string mkr;
-	    mkr += k::quote;
-	    mkr += "url(#";
-	    mkr += sstyl.marker_defs;
-	    mkr += ")";
-	    mkr += k::quote;
-
-	    _M_sstream << "marker-mid=" << mkr << k::space;
-	    _M_sstream << "marker-end=" << mkr << k::space;
-	  }
-      }
+    string strip;
+    polyline_writer(strip).add_data(polypoints, sstyl);
+    _M_sstream << strip;
+
+    // Markers reach out by their own size.
+    if (sstyl.marker_defs.empty())
+      add_bounds(points_bounds(polypoints));
+    else
+      unbound();
   }
 
   void
@@ -1059,6 +1226,7 @@ struct path_element : virtual public element_base
     string_replace(strip, pathd, d._M_d);
     string_replace(strip, len, std::to_string(d._M_length));
     _M_sstream << strip;
+    add_bounds(path_bounds(d._M_d));
   }
 
   void
@@ -1601,7 +1769,7 @@ struct svg_element : virtual public element_base
   const area		_M_area;
   const unit		_M_unit;
   const typography&	_M_typo;
-  const bool		_M_lifetime;  // scope document scope element
+  bool			_M_lifetime;  // scope document scope element
 
   svg_element(const string __title, const area& __cv,
 	      const bool lifetime = true,
@@ -1610,6 +1778,9 @@ struct svg_element : virtual public element_base
   : _M_name(__title), _M_area(__cv), _M_unit(u),
     _M_typo(__typo), _M_lifetime(lifetime)
   {
+    _M_viewport = bbox();
+    if (get_retained_mode())
+      retain();
     if (_M_lifetime)
       start();
   }
@@ -1619,6 +1790,9 @@ struct svg_element : virtual public element_base
   : _M_name(__title), _M_area(__cv), _M_unit(svg::unit::pixel),
     _M_typo(svg::k::smono_typo), _M_lifetime(lifetime)
   {
+    _M_viewport = bbox();
+    if (get_retained_mode())
+      retain();
     if (_M_lifetime)
       start(desc, autoszp);
   }
@@ -1627,6 +1801,19 @@ struct svg_element : virtual public element_base
   : _M_name(other._M_name), _M_area(other._M_area),
     _M_unit(other._M_unit), _M_typo(other._M_typo),
     _M_lifetime(other._M_lifetime)
+  {
+    _M_viewport = bbox();
+    if (get_retained_mode())
+      retain();
+  }
+
+  /// Take buffers of other, which then no longer finishes and writes
+  /// on destruction.
+  svg_element(svg_element&& other)
+  : element_base(std::move(other)),
+    _M_name(other._M_name), _M_area(other._M_area),
+    _M_unit(other._M_unit), _M_typo(other._M_typo),
+    _M_lifetime(std::exchange(other._M_lifetime, false))
   { }
 
   ~svg_element()
@@ -1674,6 +1861,8 @@ struct svg_element : virtual public element_base
   void
   start(const string& desc = "", const bool autoszp = false)
   {
+    trace_scope ts("svg_element::start");
+    MiL_SVG_PROBE1(svg__start, _M_name.c_str());
     this->start_element(autoszp);
     this->add_title();
     if (!desc.empty())
@@ -1683,11 +1872,46 @@ struct svg_element : virtual public element_base
   void
   finish(const bool writep = true)
   {
+    trace_scope ts("svg_element::finish");
     this->finish_element();
+    MiL_SVG_PROBE2(svg__finish, _M_name.c_str(), size());
     if (writep)
       this->write();
   }
 };
+
+
+/**
+   Cull elements outside the area of obj for the lifetime of this
+   object, see a60-svg-culling.h. Elements added to obj, and to the
+   groups made in this scope, are dropped if they cannot be seen. As:
+
+   svg_element obj("map", a);
+   cull_scope cs(obj);
+   ...
+
+   Nested svg elements are not culled. Elements that are to be nested,
+   as with nest_inner_element, are in other coordinates: make them
+   outside the scope.
+*/
+struct cull_scope
+{
+  bbox		_M_old;
+
+  explicit
+  cull_scope(svg_element& obj)
+  : _M_old(set_cull_viewport(bbox(0, 0, obj._M_area._M_width,
+				  obj._M_area._M_height)))
+  { obj._M_viewport = get_cull_viewport(); }
+
+  ~cull_scope()
+  { set_cull_viewport(_M_old); }
+
+  cull_scope(const cull_scope&) = delete;
+
+  cull_scope&
+  operator=(const cull_scope&) = delete;
+};
 /// @} group elements
 
 } // namespace svg
@@ -0,0 +1,653 @@
+// svg font metrics -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_FONT_METRICS_H
+#define MiL_SVG_FONT_METRICS_H 1
+
+#include "a60-svg.h"
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+
+namespace svg {
+
+/// Decode one UTF-8 code point at p, advancing p.
+/// Malformed sequences decode as U+FFFD and consume one byte.
+char32_t
+decode_utf8(const unsigned char*& p, const unsigned char* last)
+{
+  const unsigned char c = *p;
+  uint n = 0;
+  char32_t cp = 0;
+  if (c < 0x80)
+    {
+      ++p;
+      return c;
+    }
+  else if ((c & 0xe0) == 0xc0)
+    {
+      n = 1;
+      cp = c & 0x1f;
+    }
+  else if ((c & 0xf0) == 0xe0)
+    {
+      n = 2;
+      cp = c & 0x0f;
+    }
+  else if ((c & 0xf8) == 0xf0)
+    {
+      n = 3;
+      cp = c & 0x07;
+    }
+  else
+    {
+      ++p;
+      return 0xfffd;
+    }
+
+  if (last - p <= std::ptrdiff_t(n))
+    {
+      ++p;
+      return 0xfffd;
+    }
+  for (uint i = 1; i <= n; ++i)
+    {
+      if ((p[i] & 0xc0) != 0x80)
+	{
+	  ++p;
+	  return 0xfffd;
+	}
+      cp = (cp << 6) | (p[i] & 0x3f);
+    }
+  p += n + 1;
+  return cp;
+}
+
+
+/// Number of UTF-8 code points in text.
+size_t
+utf8_length(string_view text)
+{
+  size_t n = 0;
+  for (const unsigned char c : text)
+    n += (c & 0xc0) != 0x80;
+  return n;
+}
+
+
+/**
+   Horizontal metrics of one TrueType or OpenType font.
+
+   Read once from the font file: units per em and vertical extents
+   from head and hhea, advance widths from hmtx, the character map
+   from cmap (format 12, else format 4), and kerning pairs from a
+   format 0 kern table if there is one. GPOS kerning is not read.
+   For collections (.ttc), the first font is used.
+
+   Code points below 128 map through a flat table, the rest by binary
+   search over contiguous cmap ranges. Unmapped code points measure
+   as the missing glyph.
+*/
+class font_metrics
+{
+public:
+  using glyph_type = uint16_t;
+
+private:
+  struct cmap_range
+  {
+    char32_t	first;
+    char32_t	last;
+    uint32_t	glyph;		///< Glyph of first.
+  };
+
+  using bytes = std::basic_string_view<unsigned char>;
+
+  string				_M_family;
+  string				_M_subfamily;
+  uint					_M_units_per_em = 1000;
+  int					_M_ascender = 0;
+  int					_M_descender = 0;
+  int					_M_line_gap = 0;
+  std::vector<uint16_t>			_M_advances;
+  std::array<glyph_type, 128>		_M_ascii_glyphs = { };
+  std::array<uint16_t, 128>		_M_ascii_advances = { };
+  std::vector<cmap_range>		_M_cmap;
+  std::unordered_map<uint32_t, int16_t>	_M_kern;
+  bool					_M_goodp = false;
+
+  static uint16_t
+  be16(const bytes b, const size_t off)
+  { return off + 2 <= b.size() ? (b[off] << 8) | b[off + 1] : 0; }
+
+  static int16_t
+  bes16(const bytes b, const size_t off)
+  { return static_cast<int16_t>(be16(b, off)); }
+
+  static uint32_t
+  be32(const bytes b, const size_t off)
+  { return (uint32_t(be16(b, off)) << 16) | be16(b, off + 2); }
+
+  /// Table with four character tag, or empty if not found.
+  static bytes
+  find_table(const bytes font, const size_t fontoff, const char* tag)
+  {
+    const uint ntables = be16(font, fontoff + 4);
+    for (uint i = 0; i < ntables; ++i)
+      {
+	const size_t rec = fontoff + 12 + 16 * i;
+	if (rec + 16 > font.size())
+	  break;
+	if (std::memcmp(font.data() + rec, tag, 4) == 0)
+	  {
+	    const size_t off = be32(font, rec + 8);
+	    const size_t len = be32(font, rec + 12);
+	    if (off + len <= font.size())
+	      return font.substr(off, len);
+	    break;
+	  }
+      }
+    return bytes();
+  }
+
+  /// Offset of first font, to skip the header of collections.
+  static size_t
+  first_font_offset(const bytes font)
+  {
+    if (font.size() >= 16 && std::memcmp(font.data(), "ttcf", 4) == 0)
+      return be32(font, 12);
+    return 0;
+  }
+
+  /// Name string nameid, from a Windows Unicode or Mac Roman record.
+  static string
+  read_name(const bytes name, const uint nameid)
+  {
+    const uint count = be16(name, 2);
+    const size_t strings = be16(name, 4);
+    string mac;
+    for (uint i = 0; i < count; ++i)
+      {
+	const size_t rec = 6 + 12 * i;
+	const uint platform = be16(name, rec);
+	const uint id = be16(name, rec + 6);
+	const size_t len = be16(name, rec + 8);
+	const size_t off = strings + be16(name, rec + 10);
+	if (id != nameid || off + len > name.size())
+	  continue;
+
+	if (platform == 3 || platform == 0)
+	  {
+	    // UTF-16BE, keep the BMP as UTF-8.
+	    string ret;
+	    for (size_t j = 0; j + 1 < len; j += 2)
+	      {
+		const char32_t c = be16(name, off + j);
+		if (c < 0x80)
+		  ret += char(c);
+		else if (c < 0x800)
+		  {
+		    ret += char(0xc0 | (c >> 6));
+		    ret += char(0x80 | (c & 0x3f));
+		  }
+		else
+		  {
+		    ret += char(0xe0 | (c >> 12));
+		    ret += char(0x80 | ((c >> 6) & 0x3f));
+		    ret += char(0x80 | (c & 0x3f));
+		  }
+	      }
+	    return ret;
+	  }
+	if (platform == 1 && mac.empty())
+	  mac.assign(reinterpret_cast<const char*>(name.data()) + off, len);
+      }
+    return mac;
+  }
+
+  void
+  add_mapping(const char32_t c, const uint32_t g)
+  {
+    if (!_M_cmap.empty())
+      {
+	cmap_range& r = _M_cmap.back();
+	if (c == r.last + 1 && g == r.glyph + (c - r.first))
+	  {
+	    r.last = c;
+	    return;
+	  }
+      }
+    _M_cmap.push_back({ c, c, g });
+  }
+
+  void
+  read_cmap_format12(const bytes sub)
+  {
+    const uint32_t ngroups = be32(sub, 12);
+    for (uint32_t i = 0; i < ngroups && 16 + 12 * (i + 1) <= sub.size(); ++i)
+      {
+	const size_t grp = 16 + 12 * i;
+	const char32_t first = be32(sub, grp);
+	const char32_t last = be32(sub, grp + 4);
+	if (first <= last)
+	  _M_cmap.push_back({ first, last, be32(sub, grp + 8) });
+      }
+  }
+
+  void
+  read_cmap_format4(const bytes sub)
+  {
+    const size_t segcount = be16(sub, 6) / 2;
+    const size_t ends = 14;
+    const size_t starts = ends + 2 * segcount + 2;
+    const size_t deltas = starts + 2 * segcount;
+    const size_t ranges = deltas + 2 * segcount;
+    for (size_t i = 0; i < segcount; ++i)
+      {
+	const char32_t first = be16(sub, starts + 2 * i);
+	const char32_t last = be16(sub, ends + 2 * i);
+	const uint delta = be16(sub, deltas + 2 * i);
+	const size_t rangepos = ranges + 2 * i;
+	const uint rangeoff = be16(sub, rangepos);
+	for (char32_t c = first; c <= last && c != 0xffff; ++c)
+	  {
+	    uint g = 0;
+	    if (rangeoff == 0)
+	      g = (c + delta) & 0xffff;
+	    else
+	      {
+		g = be16(sub, rangepos + rangeoff + 2 * (c - first));
+		if (g)
+		  g = (g + delta) & 0xffff;
+	      }
+	    if (g)
+	      add_mapping(c, g);
+	  }
+      }
+  }
+
+  void
+  read_cmap(const bytes cmap)
+  {
+    // Prefer full Unicode repertoire, then the BMP.
+    const uint ntables = be16(cmap, 2);
+    size_t best = 0;
+    uint bestrank = 0;
+    for (uint i = 0; i < ntables; ++i)
+      {
+	const size_t rec = 4 + 8 * i;
+	const uint platform = be16(cmap, rec);
+	const uint encoding = be16(cmap, rec + 2);
+	const size_t off = be32(cmap, rec + 4);
+	const uint format = be16(cmap, off);
+	uint rank = 0;
+	if (format == 12 && (platform == 0 || (platform == 3 && encoding == 10)))
+	  rank = 2;
+	else if (format == 4 && (platform == 0 || (platform == 3 && encoding == 1)))
+	  rank = 1;
+	if (rank > bestrank)
+	  {
+	    best = off;
+	    bestrank = rank;
+	  }
+      }
+
+    if (bestrank == 2)
+      read_cmap_format12(cmap.substr(best));
+    else if (bestrank == 1)
+      read_cmap_format4(cmap.substr(best));
+    std::sort(_M_cmap.begin(), _M_cmap.end(),
+	      [](const cmap_range& r1, const cmap_range& r2)
+	      { return r1.first < r2.first; });
+  }
+
+  void
+  read_kern(const bytes kern)
+  {
+    // Only version 0 (OpenType) tables, horizontal format 0 subtables.
+    if (be16(kern, 0) != 0)
+      return;
+    const uint ntables = be16(kern, 2);
+    size_t sub = 4;
+    for (uint i = 0; i < ntables && sub + 6 <= kern.size(); ++i)
+      {
+	const size_t len = be16(kern, sub + 2);
+	const uint coverage = be16(kern, sub + 4);
+	const bool horizontalp = (coverage & 0x1) && !(coverage & 0x6);
+	if ((coverage >> 8) == 0 && horizontalp)
+	  {
+	    const uint npairs = be16(kern, sub + 6);
+	    for (uint j = 0; j < npairs; ++j)
+	      {
+		const size_t pair = sub + 14 + 6 * j;
+		if (pair + 6 > kern.size())
+		  break;
+		const uint32_t key = be32(kern, pair);
+		_M_kern[key] += bes16(kern, pair + 4);
+	      }
+	  }
+	if (len == 0)
+	  break;
+	sub += len;
+      }
+  }
+
+  void
+  load(const bytes font)
+  {
+    const size_t fontoff = first_font_offset(font);
+    const bytes head = find_table(font, fontoff, "head");
+    const bytes hhea = find_table(font, fontoff, "hhea");
+    const bytes hmtx = find_table(font, fontoff, "hmtx");
+    const bytes maxp = find_table(font, fontoff, "maxp");
+    const bytes cmap = find_table(font, fontoff, "cmap");
+    if (head.size() < 54 || hhea.size() < 36 || maxp.size() < 6 || cmap.empty())
+      return;
+
+    _M_units_per_em = be16(head, 18);
+    if (_M_units_per_em == 0)
+      return;
+    _M_ascender = bes16(hhea, 4);
+    _M_descender = bes16(hhea, 6);
+    _M_line_gap = bes16(hhea, 8);
+
+    const uint nglyphs = be16(maxp, 4);
+    const uint nhmetrics = std::min<uint>(be16(hhea, 34), hmtx.size() / 4);
+    if (nglyphs == 0 || nhmetrics == 0)
+      return;
+    _M_advances.resize(nglyphs);
+    for (uint i = 0; i < nglyphs; ++i)
+      _M_advances[i] = be16(hmtx, 4 * std::min(i, nhmetrics - 1));
+
+    read_cmap(cmap);
+    read_kern(find_table(font, fontoff, "kern"));
+
+    const bytes name = find_table(font, fontoff, "name");
+    _M_family = read_name(name, 1);
+    _M_subfamily = read_name(name, 2);
+
+    for (char32_t c = 0; c < 128; ++c)
+      {
+	_M_ascii_glyphs[c] = glyph(c, false);
+	_M_ascii_advances[c] = _M_advances[_M_ascii_glyphs[c]];
+      }
+    _M_goodp = true;
+  }
+
+  glyph_type
+  glyph(const char32_t c, const bool asciip) const
+  {
+    if (asciip && c < 128)
+      return _M_ascii_glyphs[c];
+
+    auto i = std::upper_bound(_M_cmap.begin(), _M_cmap.end(), c,
+			      [](const char32_t v, const cmap_range& r)
+			      { return v < r.first; });
+    if (i == _M_cmap.begin())
+      return 0;
+    --i;
+    if (c > i->last)
+      return 0;
+    const uint32_t g = i->glyph + (c - i->first);
+    return g < _M_advances.size() ? g : 0;
+  }
+
+public:
+  font_metrics() = default;
+
+  /// Metrics from font file contents.
+  explicit
+  font_metrics(string_view data)
+  { load(bytes(reinterpret_cast<const unsigned char*>(data.data()),
+	       data.size())); }
+
+  /// Read font file, or return empty metrics if it cannot be read.
+  static font_metrics
+  from_file(const string& fname)
+  {
+    std::ifstream ifs(fname, std::ios::binary);
+    if (!ifs.good())
+      return font_metrics();
+    string data((std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+    return font_metrics(data);
+  }
+
+  /// Family and subfamily names of a font file, without loading metrics.
+  static std::pair<string, string>
+  read_names(const string& fname)
+  {
+    std::ifstream ifs(fname, std::ios::binary);
+    string data((std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+    const bytes font(reinterpret_cast<const unsigned char*>(data.data()),
+		     data.size());
+    const bytes name = find_table(font, first_font_offset(font), "name");
+    return { read_name(name, 1), read_name(name, 2) };
+  }
+
+  bool
+  good() const
+  { return _M_goodp; }
+
+  const string&
+  family() const
+  { return _M_family; }
+
+  const string&
+  subfamily() const
+  { return _M_subfamily; }
+
+  uint
+  units_per_em() const
+  { return _M_units_per_em; }
+
+  glyph_type
+  glyph(const char32_t c) const
+  { return glyph(c, true); }
+
+  /// Kerning adjustment between glyphs, in font units.
+  int
+  kerning(const glyph_type left, const glyph_type right) const
+  {
+    if (_M_kern.empty())
+      return 0;
+    auto i = _M_kern.find((uint32_t(left) << 16) | right);
+    return i != _M_kern.end() ? i->second : 0;
+  }
+
+  /**
+     Advance width of UTF-8 text in font units, with kerning.
+
+     One pass over the bytes. ASCII runs in fonts without kerning
+     only sum a flat table, which compilers can vectorize.
+  */
+  long
+  advance(string_view text) const
+  {
+    if (!_M_goodp)
+      return 0;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* last = p + text.size();
+    long w = 0;
+    if (_M_kern.empty())
+      {
+	while (p != last)
+	  {
+	    const unsigned char* run = p;
+	    while (p != last && *p < 0x80)
+	      ++p;
+	    for (const unsigned char* q = run; q != p; ++q)
+	      w += _M_ascii_advances[*q];
+	    if (p != last)
+	      w += _M_advances[glyph(decode_utf8(p, last))];
+	  }
+	return w;
+      }
+
+    glyph_type prev = 0;
+    bool firstp = true;
+    while (p != last)
+      {
+	const glyph_type g = glyph(decode_utf8(p, last));
+	w += _M_advances[g];
+	if (!firstp)
+	  w += kerning(prev, g);
+	prev = g;
+	firstp = false;
+      }
+    return w;
+  }
+
+  /// Width in pixels of UTF-8 text at font size sz.
+  double
+  width(string_view text, const double sz) const
+  { return double(advance(text)) * sz / _M_units_per_em; }
+
+  /// Ascender height in pixels at font size sz.
+  double
+  ascender(const double sz) const
+  { return double(_M_ascender) * sz / _M_units_per_em; }
+
+  /// Descender depth in pixels at font size sz, usually negative.
+  double
+  descender(const double sz) const
+  { return double(_M_descender) * sz / _M_units_per_em; }
+
+  /// Baseline to baseline distance in pixels at font size sz.
+  double
+  line_height(const double sz) const
+  { return double(_M_ascender - _M_descender + _M_line_gap) * sz
+      / _M_units_per_em; }
+};
+
+
+/// Font file for a face, and its metrics once loaded.
+struct font_registry_entry
+{
+  string				path;
+  string				subfamily;
+  std::shared_ptr<const font_metrics>	metrics;
+};
+
+using font_registry_map = std::unordered_map<string, font_registry_entry>;
+
+
+/// Known fonts, keyed by face name as in typography::_M_face.
+font_registry_map&
+get_font_registry()
+{
+  static font_registry_map registry;
+  return registry;
+}
+
+
+/// Register font file for face, or for its family name if face is
+/// empty. Metrics are read on first use. Returns face registered.
+string
+register_font_file(const string& path, const string& face = "")
+{
+  string fface(face);
+  string subfamily;
+  if (fface.empty())
+    std::tie(fface, subfamily) = font_metrics::read_names(path);
+  if (!fface.empty())
+    get_font_registry()[fface] = { path, subfamily, nullptr };
+  return fface;
+}
+
+
+/**
+   Register all TrueType/OpenType files under dir by family name,
+   for example "/usr/share/fonts" or "~/.local/share/fonts" expanded.
+
+   A family with several files (weights, italics) keeps the Regular
+   or Book style if there is one, else the first found. Returns the
+   number of families registered.
+*/
+uint
+register_font_directory(const string& dir)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  font_registry_map& registry = get_font_registry();
+  uint n = 0;
+  for (fs::recursive_directory_iterator i(dir, ec), last; !ec && i != last;
+       i.increment(ec))
+    {
+      if (!i->is_regular_file(ec))
+	continue;
+      string ext = i->path().extension().string();
+      std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+      if (ext != ".ttf" && ext != ".otf" && ext != ".ttc")
+	continue;
+
+      const string path = i->path().string();
+      auto [ family, subfamily ] = font_metrics::read_names(path);
+      if (family.empty())
+	continue;
+
+      const bool regularp = subfamily == "Regular" || subfamily == "Book";
+      auto found = registry.find(family);
+      if (found == registry.end())
+	{
+	  registry[family] = { path, subfamily, nullptr };
+	  ++n;
+	}
+      else if (regularp && found->second.subfamily != "Regular"
+	       && found->second.subfamily != "Book")
+	found->second = { path, subfamily, nullptr };
+    }
+  return n;
+}
+
+
+/// Metrics for face, loaded once, or nullptr if face is not
+/// registered or its file cannot be read.
+const font_metrics*
+find_font_metrics(const string& face)
+{
+  font_registry_map& registry = get_font_registry();
+  auto i = registry.find(face);
+  if (i == registry.end())
+    return nullptr;
+
+  font_registry_entry& e = i->second;
+  if (!e.metrics)
+    e.metrics = std::make_shared<const font_metrics>
+      (font_metrics::from_file(e.path));
+  return e.metrics->good() ? e.metrics.get() : nullptr;
+}
+
+
+/// Width in pixels of text set in typography typo. Uses font
+/// metrics for the face if registered, else char_width_to_px per
+/// UTF-8 code point.
+double
+text_width_to_px(string_view text, const typography& typo)
+{
+  if (const font_metrics* fm = find_font_metrics(typo._M_face))
+    return fm->width(text, typo._M_size);
+  return utf8_length(text) * char_width_to_px(typo._M_size);
+}
+
+} // namespace svg
+
+#endif
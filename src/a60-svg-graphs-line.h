@@ -164,22 +164,45 @@ find_visual_change_points(const vrange& points)
 /// Transform change points to points where the x-axis (time) matches
 /// a value in onlypoints.
 ///
+/// Points are indexed by x once, then each value in onlypoints is
+/// located by binary search, so cost is O((n + m) log n) instead of
+/// O(n * m). Output order follows onlypoints, and when several
+/// points match the same value the earliest one in points is used.
+///
 /// @param points already simplified change points
+/// @param onlypoints x values to keep, in output order
+/// @param tolerance absolute x distance that still counts as a match
 vrange
-find_tooltip_points(const vrange& points, const vspace& onlypoints)
+find_tooltip_points(const vrange& points, const vspace& onlypoints,
+		    const space_type tolerance = 0.0)
 {
+  // Index of points, sorted by x then by input position.
+  auto lessx = [&points](const size_t i, const size_t j)
+  { return get<0>(points[i]) < get<0>(points[j]); };
+
+  std::vector<size_t> idx(points.size());
+  for (size_t i = 0; i < idx.size(); ++i)
+    idx[i] = i;
+  if (!std::is_sorted(idx.begin(), idx.end(), lessx))
+    std::stable_sort(idx.begin(), idx.end(), lessx);
+
   vrange edited;
+  edited.reserve(onlypoints.size());
   for (const space_type& matchx : onlypoints)
     {
-      for (const auto&  pt : points)
-	{
-	  auto [ x, y ] = pt;
-	  if (x == matchx)
-	    {
-	      edited.push_back(pt);
-	      break;
-	    }
-	}
+      const space_type lo = matchx - tolerance;
+      const space_type hi = matchx + tolerance;
+      auto it = std::lower_bound(idx.begin(), idx.end(), lo,
+				 [&points](const size_t i, const space_type v)
+				 { return get<0>(points[i]) < v; });
+
+      // Earliest input position among all x in [lo, hi].
+      size_t found = points.size();
+      for (; it != idx.end() && get<0>(points[*it]) <= hi; ++it)
+	found = std::min(found, *it);
+
+      if (found != points.size())
+	edited.push_back(points[found]);
     }
   return edited;
 }
@@ -192,6 +215,7 @@ transform_to_graph_points(const vrange& points,
 			  const graph_rstate& gstate,
 			  const point_2t xrange, const point_2t yrange)
 {
+  render_stage_timer t(render_stage::transform);
   auto [ minx, maxx ] = xrange;
   auto [ miny, maxy ] = yrange;
 
@@ -345,10 +369,9 @@ make_line_graph_markers(const vrange& points, const vrange& cpoints,
       string imgid(imgidbase);
       if (!imgid.empty())
 	{
-	  std::ostringstream oss;
-	  oss << std::setfill('0') << std::setw(5);
-	  oss << static_cast<uint>(vx);
-	  const string xms = oss.str();
+	  string xms = std::to_string(static_cast<uint>(vx));
+	  if (xms.size() < 5)
+	    xms.insert(0, 5 - xms.size(), '0');
 	  string imgidn(imgid + xms);
 	  imgid = script_element::tooltip_attribute(imgidn);
 	}
@@ -361,10 +384,7 @@ make_line_graph_markers(const vrange& points, const vrange& cpoints,
       //tipstr += gstate.yticu;
       tipstr += k::newline;
 
-      std::ostringstream oss;
-      oss.imbue(std::locale(""));
-      oss << std::fixed << std::setprecision(0) << vy;
-      tipstr += oss.str();
+      tipstr += to_grouped_string(vy, 0);
       //tipstr += std::to_string(static_cast<uint>(vx));
       //tipstr += gstate.xticu;
 
@@ -686,6 +706,7 @@ make_line_graph(const vrange& points, const graph_rstate& gstate,
 		const point_2t xrange, const point_2t yrange,
 		const double marker_radius = 3.0)
 {
+  trace_scope ts("make_line_graph");
   using namespace std;
   const vrange cpoints = transform_to_graph_points(points, gstate,
 						   xrange, yrange);
@@ -739,6 +760,7 @@ make_line_graph(const vrange& points, const vrange& tpoints, graph_rstate& gstat
 		const point_2t xrange, const point_2t yrange,
 		const string metadata, script_element::scope scontext)
 {
+  trace_scope ts("make_line_graph");
   using namespace std;
   const vrange cpoints = transform_to_graph_points(points, gstate,
 						   xrange, yrange);
@@ -0,0 +1,503 @@
+// svg label placement -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_LABEL_PLACEMENT_H
+#define MiL_SVG_LABEL_PLACEMENT_H 1
+
+#include "a60-svg.h"
+#include "a60-svg-font-metrics.h"
+#include <span>
+
+
+namespace svg {
+
+/**
+   R-tree of bounding boxes.
+
+   Nodes hold up to max_entries children. Insertion descends to the
+   leaf needing least enlargement, and full nodes split in half
+   along the axis where the centers of their entries spread most.
+   Queries only visit subtrees whose boxes overlap the query, so
+   they are O(log n) for n boxes that are spread out, as placed
+   labels are.
+*/
+class bbox_rtree
+{
+public:
+  using index_type = uint;
+
+  static constexpr index_type	npos = std::numeric_limits<index_type>::max();
+  static constexpr uint		max_entries = 8;
+
+private:
+  struct node
+  {
+    bbox			box;
+    bool			leafp;
+    std::vector<index_type>	entries;  ///< Box ids if leaf, else node ids.
+  };
+
+  std::vector<node>	_M_nodes;
+  std::vector<bbox>	_M_boxes;
+  index_type		_M_root = npos;
+
+  const bbox&
+  entry_box(const node& n, const index_type e) const
+  { return n.leafp ? _M_boxes[e] : _M_nodes[e].box; }
+
+  static space_type
+  enlargement(const bbox& b, const bbox& add)
+  {
+    bbox u(b);
+    u.extend(add);
+    return u.box_area() - b.box_area();
+  }
+
+  /// Child of internal node n that needs least enlargement to hold b.
+  index_type
+  choose_child(const index_type n, const bbox& b) const
+  {
+    index_type best = npos;
+    space_type beste = 0;
+    space_type besta = 0;
+    for (const index_type c : _M_nodes[n].entries)
+      {
+	const bbox& cb = _M_nodes[c].box;
+	const space_type e = enlargement(cb, b);
+	const space_type a = cb.box_area();
+	if (best == npos || e < beste || (e == beste && a < besta))
+	  {
+	    best = c;
+	    beste = e;
+	    besta = a;
+	  }
+      }
+    return best;
+  }
+
+  void
+  recompute_box(const index_type n)
+  {
+    bbox b;
+    for (const index_type e : _M_nodes[n].entries)
+      b.extend(entry_box(_M_nodes[n], e));
+    _M_nodes[n].box = b;
+  }
+
+  /// Split node n in two, returning id of the new sibling.
+  index_type
+  split(const index_type n)
+  {
+    std::vector<index_type> es = std::move(_M_nodes[n].entries);
+    const bool leafp = _M_nodes[n].leafp;
+
+    auto centerx = [&](const index_type e)
+    {
+      const bbox& b = leafp ? _M_boxes[e] : _M_nodes[e].box;
+      return b._M_x0 + b._M_x1;
+    };
+    auto centery = [&](const index_type e)
+    {
+      const bbox& b = leafp ? _M_boxes[e] : _M_nodes[e].box;
+      return b._M_y0 + b._M_y1;
+    };
+
+    auto [ xmin, xmax ] = std::minmax_element(es.begin(), es.end(),
+					      [&](auto e1, auto e2)
+					      { return centerx(e1) < centerx(e2); });
+    auto [ ymin, ymax ] = std::minmax_element(es.begin(), es.end(),
+					      [&](auto e1, auto e2)
+					      { return centery(e1) < centery(e2); });
+    const bool xaxisp = (centerx(*xmax) - centerx(*xmin)
+			 >= centery(*ymax) - centery(*ymin));
+    if (xaxisp)
+      std::sort(es.begin(), es.end(), [&](auto e1, auto e2)
+		{ return centerx(e1) < centerx(e2); });
+    else
+      std::sort(es.begin(), es.end(), [&](auto e1, auto e2)
+		{ return centery(e1) < centery(e2); });
+
+    const auto mid = es.begin() + es.size() / 2;
+    const index_type sib = _M_nodes.size();
+    _M_nodes.push_back(node { bbox(), leafp, { mid, es.end() } });
+    _M_nodes[n].entries.assign(es.begin(), mid);
+    recompute_box(n);
+    recompute_box(sib);
+    return sib;
+  }
+
+public:
+  bbox_rtree() = default;
+
+  size_t
+  size() const
+  { return _M_boxes.size(); }
+
+  bool
+  empty() const
+  { return _M_boxes.empty(); }
+
+  /// Box inserted as id i.
+  const bbox&
+  operator[](const index_type i) const
+  { return _M_boxes[i]; }
+
+  void
+  clear()
+  {
+    _M_nodes.clear();
+    _M_boxes.clear();
+    _M_root = npos;
+  }
+
+  /// Insert box, returning its id.
+  index_type
+  insert(const bbox& b)
+  {
+    const index_type id = _M_boxes.size();
+    _M_boxes.push_back(b);
+    if (_M_root == npos)
+      {
+	_M_root = _M_nodes.size();
+	_M_nodes.push_back(node { bbox(), true, { } });
+      }
+
+    // Descend, remembering the path for splits on the way back up.
+    std::vector<index_type> path;
+    index_type n = _M_root;
+    while (!_M_nodes[n].leafp)
+      {
+	path.push_back(n);
+	n = choose_child(n, b);
+      }
+    _M_nodes[n].entries.push_back(id);
+    _M_nodes[n].box.extend(b);
+
+    index_type sib = npos;
+    if (_M_nodes[n].entries.size() > max_entries)
+      sib = split(n);
+    for (auto i = path.rbegin(); i != path.rend(); ++i)
+      {
+	const index_type p = *i;
+	_M_nodes[p].box.extend(b);
+	if (sib != npos)
+	  {
+	    _M_nodes[p].entries.push_back(sib);
+	    sib = npos;
+	    if (_M_nodes[p].entries.size() > max_entries)
+	      sib = split(p);
+	  }
+      }
+
+    // Root split, grow tree by one level.
+    if (sib != npos)
+      {
+	const index_type r = _M_nodes.size();
+	_M_nodes.push_back(node { bbox(), false, { _M_root, sib } });
+	_M_root = r;
+	recompute_box(r);
+      }
+    return id;
+  }
+
+  /// True if any box overlaps b.
+  bool
+  intersectsp(const bbox& b) const
+  {
+    if (_M_root == npos)
+      return false;
+
+    std::vector<index_type> stack(1, _M_root);
+    while (!stack.empty())
+      {
+	const node& n = _M_nodes[stack.back()];
+	stack.pop_back();
+	if (!n.box.intersectsp(b))
+	  continue;
+	for (const index_type e : n.entries)
+	  {
+	    if (!entry_box(n, e).intersectsp(b))
+	      continue;
+	    if (n.leafp)
+	      return true;
+	    stack.push_back(e);
+	  }
+      }
+    return false;
+  }
+
+  /// Ids of all boxes overlapping b, in no particular order.
+  std::vector<index_type>
+  query(const bbox& b) const
+  {
+    std::vector<index_type> ret;
+    if (_M_root == npos)
+      return ret;
+
+    std::vector<index_type> stack(1, _M_root);
+    while (!stack.empty())
+      {
+	const node& n = _M_nodes[stack.back()];
+	stack.pop_back();
+	for (const index_type e : n.entries)
+	  if (entry_box(n, e).intersectsp(b))
+	    {
+	      if (n.leafp)
+		ret.push_back(e);
+	      else
+		stack.push_back(e);
+	    }
+      }
+    return ret;
+  }
+};
+
+
+/// Size in pixels of text set in typography typo. Width is from font
+/// metrics if the face is registered, see text_width_to_px.
+area<>
+label_extent(const string& text, const typography& typo)
+{
+  return area<>(text_width_to_px(text, typo),
+		char_height_to_px(typo._M_size));
+}
+
+
+/**
+   Bounding box of radial text, as placed by radial_text_r.
+
+   Text of extent ext starts at radius r on the ray for angle angled,
+   as from get_angle, and runs outward along the ray, centered
+   across it. The box is the axis-aligned box around the rotated
+   text, so is conservative.
+*/
+bbox
+radial_text_bbox(const point_2t origin, const double angled, const double r,
+		 const area<> ext)
+{
+  const double angler = (k::pi / 180.0) * zero_angle_north_cw(angled);
+  const double dx = std::cos(angler);
+  const double dy = -std::sin(angler);
+
+  // Across the ray, half the text height each side.
+  const double hx = -dy * ext._M_height / 2;
+  const double hy = dx * ext._M_height / 2;
+
+  auto [ cx, cy ] = origin;
+  const double r2 = r + ext._M_width;
+  bbox b;
+  b.extend({ cx + r * dx + hx, cy + r * dy + hy });
+  b.extend({ cx + r * dx - hx, cy + r * dy - hy });
+  b.extend({ cx + r2 * dx + hx, cy + r2 * dy + hy });
+  b.extend({ cx + r2 * dx - hx, cy + r2 * dy - hy });
+  return b;
+}
+
+
+/// Position of radial label, and its box.
+struct radial_candidate
+{
+  double	angled;
+  double	r;
+  bbox		box;
+};
+
+using radial_candidates = std::vector<radial_candidate>;
+
+
+/**
+   Candidate positions for a radial label, most preferred first.
+
+   Starts at (angled, r). Then splays around angled, alternating
+   after and before by dangle, up to nangle steps each way. Then
+   staggers outward, repeating the splay at r + rstep, r + 2 * rstep,
+   for nradius orbits in all.
+*/
+radial_candidates
+make_radial_candidates(const point_2t origin, const double angled,
+		       const double r, const area<> ext,
+		       const double dangle = 0, const uint nangle = 0,
+		       const double rstep = 0, const uint nradius = 1)
+{
+  radial_candidates ret;
+  ret.reserve(std::max(nradius, 1u) * (2 * nangle + 1));
+  for (uint j = 0; j < std::max(nradius, 1u); ++j)
+    {
+      const double rj = r + j * rstep;
+      ret.push_back({ angled, rj, radial_text_bbox(origin, angled, rj, ext) });
+      for (uint i = 1; i <= nangle; ++i)
+	for (const double d : { angled + i * dangle, angled - i * dangle })
+	  ret.push_back({ d, rj, radial_text_bbox(origin, d, rj, ext) });
+    }
+  return ret;
+}
+
+
+/// Label with candidate positions, for priority placement.
+struct label_request
+{
+  int			priority;	///< Higher places first.
+  std::vector<bbox>	candidates;	///< Most preferred first.
+};
+
+
+/**
+   Placement of labels and other marks without overlap.
+
+   Placed boxes are kept in an R-tree. Greedy placement takes labels
+   in call order and puts each at its first free candidate. Priority
+   placement sorts a batch of requests first. Marks that must stay
+   where they are, like glyphs and satellite circles, are reserved so
+   labels avoid them.
+*/
+class label_placer
+{
+private:
+  bbox_rtree	_M_placed;
+  space_type	_M_margin;
+
+public:
+  /// @param margin minimum gap kept between placed boxes.
+  explicit
+  label_placer(const space_type margin = 0) : _M_margin(margin) { }
+
+  const bbox_rtree&
+  placed() const
+  { return _M_placed; }
+
+  void
+  clear()
+  { _M_placed.clear(); }
+
+  bool
+  collidesp(const bbox& b) const
+  { return _M_placed.intersectsp(b.inflate(_M_margin)); }
+
+  /// Add box whether or not it collides.
+  void
+  reserve(const bbox& b)
+  { _M_placed.insert(b); }
+
+  /// Add box if free, returning true if added.
+  bool
+  place(const bbox& b)
+  {
+    if (collidesp(b))
+      return false;
+    _M_placed.insert(b);
+    return true;
+  }
+
+  /// Place at first free candidate, returning its position, or -1
+  /// if all collide, in which case nothing is added.
+  ssize_type
+  place_first(std::span<const bbox> candidates)
+  {
+    for (size_t i = 0; i < candidates.size(); ++i)
+      if (place(candidates[i]))
+	return i;
+    return -1;
+  }
+
+  /// As above, for radial candidates.
+  ssize_type
+  place_first(const radial_candidates& candidates)
+  {
+    for (size_t i = 0; i < candidates.size(); ++i)
+      if (place(candidates[i].box))
+	return i;
+    return -1;
+  }
+
+  /// Place requests by descending priority, ties in request order.
+  /// Returns the chosen candidate of each request, or -1 if none fit.
+  std::vector<ssize_type>
+  place_by_priority(const std::vector<label_request>& reqs)
+  {
+    std::vector<size_t> order(reqs.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t i1, size_t i2)
+		     { return reqs[i1].priority > reqs[i2].priority; });
+
+    std::vector<ssize_type> ret(reqs.size(), -1);
+    for (const size_t i : order)
+      ret[i] = place_first(reqs[i].candidates);
+    return ret;
+  }
+};
+
+
+/// Active label placer used by radial helpers, if any.
+label_placer*&
+get_label_placer()
+{
+  static label_placer* placer(nullptr);
+  return placer;
+}
+
+
+/// Set active label placer, nullptr to turn off placement.
+/// Returns the previous placer.
+label_placer*
+set_label_placer(label_placer* placer)
+{
+  label_placer*& active = get_label_placer();
+  label_placer* old = active;
+  active = placer;
+  return old;
+}
+
+
+/**
+   Radius for radial text with the active label placer, if any.
+
+   Tries r, then staggers outward by rstep, up to ntries orbits. The
+   chosen box is placed. If every orbit collides, r is used and its
+   box is reserved anyway. Without an active placer, returns r.
+*/
+double
+place_radial_label(const point_2t origin, const double angled, const double r,
+		   const string& text, const typography& typo,
+		   const double rstep, const uint ntries = 8)
+{
+  label_placer* placer = get_label_placer();
+  if (!placer || text.empty())
+    return r;
+
+  const area<> ext = label_extent(text, typo);
+  radial_candidates cands = make_radial_candidates(origin, angled, r, ext,
+						   0, 0, rstep, ntries);
+  const ssize_type i = placer->place_first(cands);
+  if (i < 0)
+    {
+      placer->reserve(cands.front().box);
+      return r;
+    }
+  return cands[i].r;
+}
+
+
+/// Reserve circle of radius r at p with the active label placer, if any.
+void
+reserve_label_circle(const point_2t p, const double r)
+{
+  if (label_placer* placer = get_label_placer())
+    placer->reserve(bbox::centered_at(p, 2 * r, 2 * r));
+}
+
+} // namespace svg
+
+#endif
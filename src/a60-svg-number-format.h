@@ -0,0 +1,231 @@
+// svg number formatting -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_NUMBER_FORMAT_H
+#define MiL_SVG_NUMBER_FORMAT_H 1
+
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <locale>
+#include <stdexcept>
+
+
+namespace svg {
+
+/**
+   Rules for grouped numbers, as in std::numpunct.
+
+   grouping is the size of each digit group from the right, with the
+   last size repeating. An empty grouping means no separators.
+*/
+struct number_format
+{
+  char		thousands_sep = ',';
+  char		decimal_point = '.';
+  string	grouping = "\3";
+
+  /// Rules of locale loc.
+  static number_format
+  from_locale(const std::locale& loc)
+  {
+    const auto& np = std::use_facet<std::numpunct<char>>(loc);
+    return { np.thousands_sep(), np.decimal_point(), np.grouping() };
+  }
+
+  /// Rules of the user's preferred locale, as std::locale(""), or of
+  /// the classic "C" locale if that is not valid.
+  static number_format
+  from_environment()
+  {
+    try
+      { return from_locale(std::locale("")); }
+    catch (const std::runtime_error&)
+      { return from_locale(std::locale::classic()); }
+  }
+};
+
+
+/// Number rules used for labels, read from the environment once.
+number_format&
+get_number_format()
+{
+  static number_format nf = number_format::from_environment();
+  return nf;
+}
+
+
+/// Set number rules used for labels, returning the old rules.
+number_format
+set_number_format(const number_format& nf)
+{
+  number_format& active = get_number_format();
+  number_format old = active;
+  active = nf;
+  return old;
+}
+
+
+/**
+   Insert group separators into the digits in [first, last), in place.
+
+   Separators go in the buffer up to bufend. If there is no room,
+   digits are left ungrouped. Returns the new end.
+*/
+char*
+group_digits(char* first, char* last, char* bufend, const number_format& nf)
+{
+  if (nf.grouping.empty())
+    return last;
+
+  // Group sizes from the right, counting separators needed.
+  const size_t ndigits = last - first;
+  size_t nseps = 0;
+  size_t pos = 0;
+  size_t gi = 0;
+  while (true)
+    {
+      const int g = nf.grouping[std::min(gi, nf.grouping.size() - 1)];
+      if (g <= 0 || g == CHAR_MAX || pos + g >= ndigits)
+	break;
+      pos += g;
+      ++nseps;
+      ++gi;
+    }
+  if (nseps == 0 || last + nseps > bufend)
+    return last;
+
+  // Move digits right to left, dropping in separators.
+  char* const end = last + nseps;
+  char* out = end;
+  char* in = last;
+  gi = 0;
+  int left = nf.grouping[0];
+  while (nseps)
+    {
+      *--out = *--in;
+      if (--left == 0)
+	{
+	  *--out = nf.thousands_sep;
+	  --nseps;
+	  gi = std::min(gi + 1, nf.grouping.size() - 1);
+	  left = nf.grouping[gi];
+	}
+    }
+  return end;
+}
+
+
+/**
+   Format integer v with group separators into [first, last), with
+   to_chars. Returns end of output, or first if it does not fit.
+*/
+template<typename _Int>
+requires std::is_integral_v<_Int>
+char*
+format_number(char* first, char* last, const _Int v,
+	      const number_format& nf = get_number_format())
+{
+  auto [ ptr, ec ] = std::to_chars(first, last, v);
+  if (ec != std::errc())
+    return first;
+
+  char* digits = first + (*first == '-');
+  return group_digits(digits, ptr, last, nf);
+}
+
+
+/**
+   Format v in fixed notation with precision digits after the decimal
+   point, group separators, and decimal point from nf, into [first,
+   last). Returns end of output, or first if it does not fit.
+*/
+char*
+format_number(char* first, char* last, const double v, const int precision,
+	      const number_format& nf = get_number_format())
+{
+  auto [ ptr, ec ] = std::to_chars(first, last, v, std::chars_format::fixed,
+				   precision);
+  if (ec != std::errc())
+    return first;
+
+  // Non-finite values have no digits to group.
+  char* digits = first + (*first == '-');
+  if (digits == ptr || *digits < '0' || *digits > '9')
+    return ptr;
+
+  // Park the fraction at the end of the buffer while grouping.
+  char* point = std::find(digits, ptr, '.');
+  const size_t nfrac = ptr - point;
+  char* frac = last - nfrac;
+  std::memmove(frac, point, nfrac);
+  char* iend = group_digits(digits, point, frac, nf);
+  std::memmove(iend, frac, nfrac);
+  if (nfrac)
+    *iend = nf.decimal_point;
+  return iend + nfrac;
+}
+
+
+/// Pad or not, and copy formatted chars to a string.
+string
+to_padded_string(const char* first, const char* last, const uint width,
+		 const bool leftp)
+{
+  const size_t n = last - first;
+  if (n >= width)
+    return string(first, n);
+
+  string ret;
+  ret.reserve(width);
+  if (!leftp)
+    ret.append(width - n, k::space);
+  ret.append(first, n);
+  if (leftp)
+    ret.append(width - n, k::space);
+  return ret;
+}
+
+
+/// Integer v grouped, padded with spaces to width, left aligned by
+/// default as std::left.
+template<typename _Int>
+requires std::is_integral_v<_Int>
+string
+to_grouped_string(const _Int v, const uint width = 0, const bool leftp = true,
+		  const number_format& nf = get_number_format())
+{
+  char buf[64];
+  char* end = format_number(buf, buf + sizeof(buf), v, nf);
+  return to_padded_string(buf, end, width, leftp);
+}
+
+
+/// Fixed point v grouped, padded with spaces to width.
+string
+to_grouped_string(const double v, const int precision, const uint width = 0,
+		  const bool leftp = true,
+		  const number_format& nf = get_number_format())
+{
+  // Largest doubles have 309 integer digits, plus separators.
+  char buf[512];
+  char* end = format_number(buf, buf + sizeof(buf), v,
+			    std::min(precision, 64), nf);
+  return to_padded_string(buf, end, width, leftp);
+}
+
+} // namespace svg
+
+#endif
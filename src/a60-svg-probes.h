@@ -0,0 +1,95 @@
+// svg static tracepoints -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_PROBES_H
+#define MiL_SVG_PROBES_H 1
+
+#include <cstdint>
+
+/**
+   PROBES
+
+   Linux USDT static tracepoints, provider izzi, for perf and
+   bpftrace on running programs. Build with MiL_SVG_USDT defined, and
+   sys/sdt.h from systemtap-sdt-dev, to add probes. A probe is one
+   nop until a tracer attaches. Otherwise, probes and their arguments
+   compile out.
+
+   Probes, with arguments:
+
+   svg__start		name
+   svg__finish		name, bytes
+   element__add		markup, bytes	(markup starts with the tag)
+   write__begin		file
+   write__end		file, bytes, nanoseconds
+   cluster__iteration	method, iteration, clusters
+   curve__samples	curve, samples
+   json__parse__begin	file
+   json__parse__end	file, bytes, nanoseconds
+
+   As:
+   bpftrace -e 'usdt:./a.out:izzi:write__end
+     { printf("%s %d %d\n", str(arg0), arg1, arg2); }'
+*/
+
+#ifdef MiL_SVG_USDT
+
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#else
+#error "MiL_SVG_USDT requires sys/sdt.h (systemtap-sdt-dev)"
+#endif
+
+#include <chrono>
+
+#define MiL_SVG_PROBE1(name, a1) DTRACE_PROBE1(izzi, name, a1)
+#define MiL_SVG_PROBE2(name, a1, a2) DTRACE_PROBE2(izzi, name, a1, a2)
+#define MiL_SVG_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(izzi, name, a1, a2, a3)
+
+#else
+
+#define MiL_SVG_PROBE1(name, a1)
+#define MiL_SVG_PROBE2(name, a1, a2)
+#define MiL_SVG_PROBE3(name, a1, a2, a3)
+
+#endif
+
+
+namespace svg {
+
+/// Elapsed time for probe arguments. Empty without MiL_SVG_USDT.
+struct probe_timer
+{
+#ifdef MiL_SVG_USDT
+  using clock_type = std::chrono::steady_clock;
+
+  clock_type::time_point	_M_start;
+
+  probe_timer() : _M_start(clock_type::now()) { }
+
+  uint64_t
+  elapsed_ns() const
+  {
+    auto d = clock_type::now() - _M_start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+#else
+  constexpr probe_timer() { }
+#endif
+};
+
+} // namespace svg
+
+#endif
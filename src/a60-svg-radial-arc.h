@@ -104,7 +104,7 @@ radiate_id_at_value(svg_element& obj, const point_2t origin,
  rotatep == rotate name text to be on an arc from the origin of the
  circle.
 */
-svg_element
+svg_element&
 radiate_ids_per_value_on_arc(svg_element& obj, const point_2t origin,
 			     const typography& typo,
 			     const id_value_umap& ivm,
@@ -112,14 +112,30 @@ radiate_ids_per_value_on_arc(svg_element& obj, const point_2t origin,
 			     const int radius, bool rotatep)
 {
   // Probe/Marker display.
-  // Loop through map key/values and put on canvas.
+  // Collect map key/values, lay out all at once, and put on canvas.
+  strings pnames;
+  std::vector<ssize_type> pvalues;
+  pnames.reserve(ivm.size());
+  pvalues.reserve(ivm.size());
   for (const auto& v : ivm)
     {
-      string pname(v.first);
-      ssize_type pvalue(v.second);
-      if (pvalue)
-	radiate_id_at_value(obj, origin, typo, pname, pvalue, value_max,
-			    radius, rotatep);
+      if (v.second)
+	{
+	  pnames.push_back(v.first);
+	  pvalues.push_back(v.second);
+	}
+    }
+
+  vspace angles(pvalues.size(), 0.0);
+  if (rotatep)
+    get_angles(pvalues, value_max, angles);
+  radial_text_layout lay = make_radial_text_layout(angles, radius, origin);
+
+  for (size_t i = 0; i < lay.size(); ++i)
+    {
+      string label = make_label_for_value(pnames[i], pvalues[i],
+					  get_label_spaces());
+      radial_text_r(obj, label, typo, lay, i, origin);
     }
 
   return obj;
@@ -156,7 +172,7 @@ radiate_ids_at_uvalue(svg_element& obj, const point_2t origin,
    splayed, and not written on top of each other on the same
    arc/angle.
 */
-svg_element
+svg_element&
 radiate_ids_per_uvalue_on_arc(svg_element& obj, const point_2t origin,
 			      const typography& typo, const id_value_umap& ivm,
 			      const ssize_type value_max,
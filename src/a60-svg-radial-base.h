@@ -24,8 +24,10 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <span>
 
 #include "a60-svg.h"
+#include "a60-svg-label-placement.h"
 
 
 namespace svg {
@@ -90,41 +92,166 @@ adjust_angle_rotation(const double dorig, const k::rrotation rot)
    Angle adjustment such that two points on the circumference path of
    radius @param r from origin are a minimum of @param dist apart.
 
-   NB: If it cannot be computed directly, returns @param minadjust, a
-   minimum adjustment angle that defaults to 0.25 degrees.
+   Chord length at angle a is 2r * sin(a / 2), so the angle is
+   2 * asin((dist / 2) / r), in degrees. Never less than @param
+   minadjust, a minimum adjustment angle that defaults to 0.25
+   degrees. If dist is wider than the diameter, no angle is far
+   enough and the result is 180 degrees, the opposite point.
 */
 inline double
 adjust_angle_at_orbit_for_distance(double r, double dist,
 				   const double minadjust = 0.25)
 {
-  // Angle between sequential id's.
-  //
-  // Given r,
-  // point p on circumference r distance from origin with angle d
-  // point pprime on circumference r from origin with angle dprime
-  // distance is the cartesian distance between p and pprime
-  //
-  // then
-  // distance = 2 * theta, where theta from sin(theta) = (rspace / 2) / r.
-  double angle(minadjust);
   const double arg((dist / 2) / r);
+  double angle(180);
   if (arg < 1.0)
+    angle = 2 * std::asin(arg) * (180.0 / k::pi);
+  return std::max(angle, minadjust);
+}
+
+
+/**
+   Batched radial layout.
+
+   Span versions of the per-id helpers above and
+   get_circumference_point_d, for laying out all ids of a radial in
+   one pass over contiguous arrays. Each matches the scalar function
+   element for element. Loops are branch-free over plain arrays, so
+   compilers can vectorize them, including sin/cos with a vector
+   math library.
+*/
+
+/// Batched get_angle: out[i] is the angle of values[i] on the radial range.
+void
+get_angles(std::span<const ssize_type> values, const ssize_type pmax,
+	   std::span<double> out)
+{
+  // As scale_value_on_range, which truncates the range to integers.
+  const auto [ mindeg, maxdeg ] = get_radial_range();
+  const ssize_type nfloor(mindeg);
+  const double rmultp(ssize_type(maxdeg) - nfloor);
+  const double valdenom(pmax);
+  const size_t n = std::min(values.size(), out.size());
+  for (size_t i = 0; i < n; ++i)
+    out[i] = (rmultp * (double(values[i]) / valdenom)) + nfloor;
+}
+
+
+/// Batched adjust_angle_rotation.
+void
+adjust_angles_rotation(std::span<const double> in, const k::rrotation rot,
+		       std::span<double> out)
+{
+  const size_t n = std::min(in.size(), out.size());
+  for (size_t i = 0; i < n; ++i)
+    out[i] = adjust_angle_rotation(in[i], rot);
+}
+
+
+/// Batched get_circumference_point_d, angles in degrees, radius per id.
+void
+get_circumference_points_d(std::span<const double> angled,
+			   std::span<const double> r, const point_2t origin,
+			   std::span<point_2t> out)
+{
+  auto [ cx, cy ] = origin;
+  const size_t n = std::min({ angled.size(), r.size(), out.size() });
+  for (size_t i = 0; i < n; ++i)
     {
-      double angler = std::asin(arg);
-      angle = angler * (180.0 / k::pi);
+      const double angler = (k::pi / 180.0) * angled[i];
+      out[i] = std::make_tuple(cx + (r[i] * std::cos(angler)),
+			       cy - (r[i] * std::sin(angler)));
     }
+}
 
-  // Verify and iterate, if it could not be computed above.
-  const point_2t origin(0, 0);
-  const point_2t p1 = get_circumference_point_d(0, r, origin);
-  point_2t p2 = get_circumference_point_d(0 + angle, r, origin);
-  while (distance_cartesian(p1, p2) < dist)
+
+/// Batched get_circumference_point_d, angles in degrees, one radius.
+void
+get_circumference_points_d(std::span<const double> angled, const double r,
+			   const point_2t origin, std::span<point_2t> out)
+{
+  auto [ cx, cy ] = origin;
+  const size_t n = std::min(angled.size(), out.size());
+  for (size_t i = 0; i < n; ++i)
     {
-      angle += minadjust;
-      p2 = get_circumference_point_d(0 + angle, r, origin);
+      const double angler = (k::pi / 180.0) * angled[i];
+      out[i] = std::make_tuple(cx + (r * std::cos(angler)),
+			       cy - (r * std::sin(angler)));
     }
+}
 
-  return angle;
+
+/**
+   Minimum spacing for ascending angles, in place.
+
+   Each id i is pushed clockwise, if needed, so that it is at least
+   @param dist from id i - 1 when both are on the orbit of radius
+   r[i]. One pass, with the angle for each orbit from
+   adjust_angle_at_orbit_for_distance.
+*/
+void
+space_angles_at_orbit_for_distance(std::span<double> angled,
+				   std::span<const double> r,
+				   const double dist,
+				   const double minadjust = 0.25)
+{
+  const size_t n = std::min(angled.size(), r.size());
+  for (size_t i = 1; i < n; ++i)
+    {
+      const double mind = adjust_angle_at_orbit_for_distance(r[i], dist,
+							     minadjust);
+      angled[i] = std::max(angled[i], angled[i - 1] + mind);
+    }
+}
+
+
+/// Text angles and positions for a set of ids placed as radial_text_r.
+struct radial_text_layout
+{
+  vspace	angles;		///< Value angle, as from get_angle.
+  vspace	textangles;	///< Rotated angle used for placement.
+  vrange	points;		///< Text position on circumference.
+
+  size_t
+  size() const
+  { return angles.size(); }
+};
+
+
+/// Lay out mirrored radial text for angles from get_angle, at radius r.
+radial_text_layout
+make_radial_text_layout(std::span<const double> angled, const double r,
+			const point_2t origin)
+{
+  render_stage_timer t(render_stage::layout);
+  radial_text_layout lay;
+  const size_t n = angled.size();
+  lay.angles.assign(angled.begin(), angled.end());
+  lay.textangles.resize(n);
+  lay.points.resize(n);
+
+  // Same mapping as radial_text_r: cw up to 180, then mirrored ccw.
+  for (size_t i = 0; i < n; ++i)
+    {
+      const double deg = angled[i];
+      const double dcw = zero_angle_north_cw(deg);
+      const double dccw = zero_angle_north_ccw(180 - (deg - 180));
+      lay.textangles[i] = deg <= 180 ? dcw : dccw;
+    }
+  get_circumference_points_d(lay.textangles, r, origin, lay.points);
+  return lay;
+}
+
+
+/// Batched get_angle and make_radial_text_layout.
+radial_text_layout
+make_radial_text_layout(std::span<const ssize_type> values,
+			const ssize_type pmax, const double r,
+			const point_2t origin)
+{
+  vspace angles(values.size());
+  get_angles(values, pmax, angles);
+  return make_radial_text_layout(angles, r, origin);
 }
 
 
@@ -166,12 +293,7 @@ make_label_for_value(string pname, ssize_type pvalue,
 		     const uint valuewidth = 9)
 {
   // Consolidate label text to be "VALUE -> NAME"
-  std::ostringstream oss;
-  oss.imbue(std::locale(""));
-  oss << std::setfill(' ') << std::setw(valuewidth)
-      << std::left << pvalue;
-
-  string label = oss.str() + " -> " + pname;
+  string label = to_grouped_string(pvalue, valuewidth) + " -> " + pname;
   return label;
 }
 
@@ -290,6 +412,31 @@ radial_text_r(svg_element& obj, string text, const typography& typo,
 }
 
 
+/// Radial text as above, for id i of a precomputed layout.
+void
+radial_text_r(svg_element& obj, string text, const typography& typo,
+	      const radial_text_layout& lay, const size_t i,
+	      const point_2t origin, const bool roriginp = false)
+{
+  const point_2t& p = lay.points[i];
+  const double d = lay.textangles[i];
+  if (lay.angles[i] <= 180)
+    {
+      if (!roriginp)
+	radial_text_cw(obj, text, typo, p, d);
+      else
+	radial_text_cw(obj, text, typo, p, d, origin);
+    }
+  else
+    {
+      if (!roriginp)
+	radial_text_ccw(obj, text, typo, p, d);
+      else
+	radial_text_ccw(obj, text, typo, p, d, origin);
+    }
+}
+
+
 // Radiate clockwise from 0 to 35x degrees about origin, placing each
 // id at a point on the circumference. Duplicate ids splay, stack,
 // or append/concatenate at, after, or around that point.
@@ -322,11 +469,14 @@ splay_ids_around(svg_element& obj, const typography& typo,
 	  auto rring = rspace / 2;
 	  const id_rstate ridst = get_id_rstate(s);
 	  style rstyl = ridst.styl;
-	  circle_element c = make_circle({x,y}, rstyl, rring);
-	  obj.add_element(c);
+	  point_to_circle(obj, {x,y}, rstyl, rring);
+	  reserve_label_circle({x,y}, rring);
 	}
 
-      radial_text_r(obj, s, typo, rprime, origin, angled2);
+      // Stagger outward on collision, if placing labels.
+      const double rtext = place_radial_label(origin, angled2, rprime, s, typo,
+					      char_height_to_px(typo._M_size));
+      radial_text_r(obj, s, typo, rtext, origin, angled2);
       angled2 += angleprimed;
     }
 }
@@ -382,6 +532,8 @@ stack_ids_at(svg_element& obj, const typography& typoo,
   for (const string& s: ids)
     {
       // XXX used to be angled + 90
+      // Move further out on collision, if placing labels.
+      r = place_radial_label(origin, angled, r, s, typo, rdelta);
       radial_text_r(obj, s, typo, r, origin, angled);
       r += rdelta;
     }
@@ -3,8 +3,7 @@
 #include <cmath>
 #include <numbers>
 #include <functional>
-#include <queue>
-#include <unordered_set>
+#include <iterator>
 #include <iostream>
 
 #include "a60-svg.h"
@@ -23,113 +22,212 @@ namespace svg {
    the function returns a std::vector<points> of hexagon centerpoints.
  */
 
-//using point_2t = std::tuple<double, double>;
+/// One cell of a radial hexagon fill, see honeycomb_iterator.
+struct honeycomb_cell
+{
+  point_2t	center;
+  space_type	angle;		///< Of center around origin.
+  uint		ring;		///< 0 is the center cell.
+};
+
+
+/**
+   Cells of a radial hexagon fill, ring by ring out from origin.
+
+   Cells are walked on integer axial coordinates (q, s), where the
+   neighbor directions are
+
+   right (1, 0), up-right (0, 1), up-left (-1, 1),
+   left (-1, 0), down-left (0, -1), down-right (1, -1)
+
+   and a cell is at origin + q * (2r, 0) + s * (r, sqrt(3) * r), so
+   nothing accumulates floating point error and no visited set is
+   needed. Ring k has 6k cells, starting at k * right and going
+   counter-clockwise around the origin (in y-up coordinates).
 
-// Hash function for point_2t to use in unordered_set
-// Use a simple hash combining x and y coordinates
-struct PointHash
+   Angle of each cell is computed in the same pass, in degrees
+   (default) or radians.
+
+   Input iterator, so million-cell fills can be streamed without
+   storing points. Compares equal to the end iterator once n cells
+   have been produced.
+*/
+class honeycomb_iterator
 {
-  std::size_t
-  operator()(const point_2t& p) const
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = honeycomb_cell;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+
+private:
+  static constexpr int	dq[6] = { 1, 0, -1, -1, 0, 1 };
+  static constexpr int	ds[6] = { 0, 1, 1, 0, -1, -1 };
+
+  point_2t	_M_origin = { 0, 0 };
+  space_type	_M_dx = 0;	///< Width of hexagon, 2r.
+  space_type	_M_dy = 0;	///< Row height, sqrt(3) * r.
+  size_t	_M_remaining = 0;
+  bool		_M_degreesp = true;
+
+  int		_M_ring = 0;
+  int		_M_side = 0;
+  int		_M_step = 0;
+  int		_M_q = 0;
+  int		_M_s = 0;
+
+  value_type	_M_cell = { { 0, 0 }, 0, 0 };
+
+  void
+  set_cell()
   {
-    auto [x, y] = p;
-    return std::hash<double>()(x) ^ (std::hash<double>()(y) << 1);
+    auto [ x, y ] = _M_origin;
+    const space_type offx = _M_dx * _M_q + (_M_dx / 2) * _M_s;
+    const space_type offy = _M_dy * _M_s;
+    double angle = std::atan2(offy, offx);
+    if (_M_degreesp)
+      angle = (180 * (angle / k::pi));
+    _M_cell = { { x + offx, y + offy }, angle, uint(_M_ring) };
   }
-};
 
-// Equality function for point_2t
-struct PointEqual
-{
-  bool
-  operator()(const point_2t& a, const point_2t& b) const
+  /// Move to the next cell on the ring walk.
+  void
+  step()
+  {
+    if (_M_ring == 0)
+      {
+	_M_ring = 1;
+	_M_q = 1;
+	_M_s = 0;
+	return;
+      }
+
+    // Walking ring k from k * right, side n steps along direction n + 2.
+    const int d = (_M_side + 2) % 6;
+    _M_q += dq[d];
+    _M_s += ds[d];
+    if (++_M_step == _M_ring)
+      {
+	_M_step = 0;
+	if (++_M_side == 6)
+	  {
+	    _M_side = 0;
+	    ++_M_ring;
+	    _M_q = _M_ring;
+	    _M_s = 0;
+	  }
+      }
+  }
+
+public:
+  /// End iterator.
+  honeycomb_iterator() = default;
+
+  honeycomb_iterator(const point_2t origin, const double r, const size_t n,
+		     const bool centerfilledp, const bool degreesp = true)
+  : _M_origin(origin), _M_dx(2.0 * r), _M_dy(std::sqrt(3.0) * r),
+    _M_remaining(n), _M_degreesp(degreesp)
   {
-    // Compare with a small epsilon for floating point precision
-    auto [ax, ay] = a;
-    auto [bx, by] = b;
-    return std::abs(ax - bx) < 1e-9 && std::abs(ay - by) < 1e-9;
+    if (!centerfilledp)
+      step();
+    if (_M_remaining)
+      set_cell();
   }
+
+  reference
+  operator*() const
+  { return _M_cell; }
+
+  pointer
+  operator->() const
+  { return &_M_cell; }
+
+  honeycomb_iterator&
+  operator++()
+  {
+    if (--_M_remaining)
+      {
+	step();
+	set_cell();
+      }
+    return *this;
+  }
+
+  honeycomb_iterator
+  operator++(int)
+  {
+    honeycomb_iterator tmp(*this);
+    ++*this;
+    return tmp;
+  }
+
+  /// Iterators are equal if they have the same number of cells left.
+  bool
+  operator==(const honeycomb_iterator& other) const
+  { return _M_remaining == other._M_remaining; }
 };
 
 
-/// Compute set of points for a radial fill of hexagons centered at p.
-vrange
-radiate_hexagon_honeycomb(const point_2t origin, const double r, const uint n,
-			  const bool centerfilledp)
+/// Range of n honeycomb cells, for range-for over a radial fill.
+struct honeycomb_range
 {
-  vrange hexagons;
-  if (n == 0)
-    return hexagons;
+  honeycomb_iterator	_M_begin;
 
-  auto [x, y] = origin;
+  honeycomb_iterator
+  begin() const
+  { return _M_begin; }
 
+  honeycomb_iterator
+  end() const
+  { return honeycomb_iterator(); }
+};
 
-  // For hexagonal grid, compute the horizontal and vertical spacing.
 
-  // Width of hexagon (flat-to-flat)
-  const double hex_width = 2.0 * r;
+/// Cells of a radial fill of hexagons centered at origin.
+/// @param degreesp angles in degrees (default), not radians.
+honeycomb_range
+honeycomb_cells(const point_2t origin, const double r, const uint n,
+		const bool centerfilledp, const bool degreesp = true)
+{ return { honeycomb_iterator(origin, r, n, centerfilledp, degreesp) }; }
 
-  // Height of hexagon (point-to-point)
-  const double hex_height = std::sqrt(3.0) * r;
 
-  // Direction vectors for the 6 neighbors in a hexagonal grid
-  const vrange directions =
-    {
-      { hex_width, 0.0 },                    // Right
-      { hex_width / 2.0, hex_height },       // Up-right
-      { -hex_width / 2.0, hex_height },      // Up-left
-      { -hex_width, 0.0 },                   // Left
-      { -hex_width / 2.0, -hex_height },     // Down-left
-      { hex_width / 2.0, -hex_height }       // Down-right
-  };
-
-  // Use BFS to generate hexagons radially
-  std::queue<point_2t> q;
-  std::unordered_set<point_2t, PointHash, PointEqual> visited;
-
-  // Ring 0 is the center hexagon.
-  if (centerfilledp)
-    {
-      q.push(origin);
-      hexagons.push_back(origin);
-    }
-  visited.insert(origin);
+/// Compute set of points for a radial fill of hexagons centered at p.
+vrange
+radiate_hexagon_honeycomb(const point_2t origin, const double r, const uint n,
+			  const bool centerfilledp)
+{
+  trace_scope ts("radiate_hexagon_honeycomb");
+  render_stage_timer t(render_stage::layout);
+  vrange hexagons;
+  hexagons.reserve(n);
+  for (const honeycomb_cell& cell : honeycomb_cells(origin, r, n,
+						      centerfilledp))
+    hexagons.push_back(cell.center);
+  return hexagons;
+}
 
-  // Ring 1 (6 hexagons around center)
-  for (uint i = 0; i < directions.size() && hexagons.size() < n; i++)
-    {
-      const auto& movement = directions[i];
-      auto [dx, dy] = movement;
-      point_2t neighbor = { x + dx, y + dy };
-      q.push(neighbor);
-      visited.insert(neighbor);
-      hexagons.push_back(neighbor);
-    }
 
-  // Generate hexagons until we reach n total
-  while (hexagons.size() < n && !q.empty())
+/// Compute set of points and their angles for a radial fill of
+/// hexagons centered at p, in one pass.
+/// @param degreesp return angles in degrees, not radians (default).
+vrange
+radiate_hexagon_honeycomb(const point_2t origin, const double r, const uint n,
+			  const bool centerfilledp, vspace& angles,
+			  const bool degreesp = true)
+{
+  trace_scope ts("radiate_hexagon_honeycomb");
+  render_stage_timer t(render_stage::layout);
+  vrange hexagons;
+  hexagons.reserve(n);
+  angles.clear();
+  angles.reserve(n);
+  for (const honeycomb_cell& cell : honeycomb_cells(origin, r, n,
+						      centerfilledp, degreesp))
     {
-      point_2t current = q.front();
-      q.pop();
-
-      auto [current_x, current_y] = current;
-
-      // Explore all 6 neighbors
-      for (const auto& dir : directions)
-	{
-	  auto [dx, dy] = dir;
-	  point_2t neighbor = {current_x + dx, current_y + dy};
-
-	  // Check if we haven't visited this point and haven't reached n yet
-	  if (visited.find(neighbor) == visited.end()
-	      && hexagons.size() < n)
-	    {
-	      visited.insert(neighbor);
-	      hexagons.push_back(neighbor);
-	      q.push(neighbor);
-	    }
-	}
+      hexagons.push_back(cell.center);
+      angles.push_back(cell.angle);
     }
-
   return hexagons;
 }
 
@@ -86,7 +86,9 @@ radiate_line_and_value(svg_element& obj, const point_2t origin,
   int glyphr = rbase + linelen + rspace;
   typography typob(typo);
   typob._M_w = typography::weight::bold;
-  radial_text_r(obj, std::to_string(v), typob, glyphr, origin, angled);
+  const string vs = std::to_string(v);
+  place_radial_label(origin, angled, glyphr, vs, typob, 0, 1);
+  radial_text_r(obj, vs, typob, glyphr, origin, angled);
   return glyphr - rstart;
 }
 
@@ -127,6 +129,7 @@ radiate_glyph(svg_element& obj, const point_2t origin, const double angled,
       string isvg = file_to_svg_insert(glyphtext);
       insert_svg_at(obj, isvg, p, 100, scaledsize, angleda + glyphrotate,
 		    idst.styl);
+      reserve_label_circle(p, scaledsize / 2);
       glyphr += scaledsize;
     }
 
@@ -134,8 +137,8 @@ radiate_glyph(svg_element& obj, const point_2t origin, const double angled,
     {
       const int vr = rstart + rspace + kra;
       point_2t p = get_circumference_point_d(angleda, vr, origin);
-      circle_element c = make_circle(p, idst.styl, kra);
-      obj.add_element(c);
+      point_to_circle(obj, p, idst.styl, kra);
+      reserve_label_circle(p, kra);
       glyphr += (2 * kra);
     }
 
@@ -172,7 +175,11 @@ radiate_glyph_and_id(svg_element& obj, const point_2t origin,
   // Id name.
   if (idst.is_visible(svg::select::text) && !id.empty())
     {
-      const int idr = rstart + glyphr + rspace;
+      // Stagger outward on collision, if placing labels.
+      const int idrbase = rstart + glyphr + rspace;
+      const int idr = place_radial_label(origin, angled, idrbase, id, typo,
+					 std::max(rspace, 1));
+      glyphr += idr - idrbase;
 
 #if 1
       // XXX playing.
@@ -187,9 +194,9 @@ radiate_glyph_and_id(svg_element& obj, const point_2t origin,
       radial_text_r(obj, id, typoz, idr, origin, angled);
 #endif
 
-      // NB: This is only an estimate of the text block size.
-      // Should be getComputedTextLength
-      glyphr += id.size() * char_width_to_px(typo._M_size);
+      // NB: Without registered font metrics, only an estimate of the
+      // text block size. See register_font_directory.
+      glyphr += text_width_to_px(id, typo);
     }
 
   return glyphr;
@@ -484,8 +491,12 @@ kusama_collision_transforms(svg_element& obj, const point_2t origin,
 
    When overlap is detected, move outward on radius if true, otherwise
    move in.
+
+   With an active label placer, see set_label_placer, glyphs and
+   values are reserved as they are drawn, and ids that would overlap
+   anything already placed stagger outward along their ray.
 */
-svg_element
+svg_element&
 kusama_ids_per_uvalue_on_arc(svg_element& obj, const point_2t origin,
 			     const typography& typo, const id_value_umap& ivm,
 			     const ssize_type value_max, const int radius,
@@ -0,0 +1,133 @@
+// svg random numbers -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_RANDOM_H
+#define MiL_SVG_RANDOM_H 1
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+
+namespace svg {
+
+/**
+   RANDOM
+
+   Counter-based random numbers. Each draw is a pure function of
+   (document seed, stream index, counter), so any stream can be
+   regenerated alone, out of order, or in parallel, with identical
+   results.
+
+   Streams are indexed per generated thing, usually one per element.
+   Functions that draw random values take a stream index argument
+   that defaults to next_random_index(), which numbers streams in
+   call order from the last set_random_seed().
+*/
+
+/// SplitMix64 finalizer, a bijective 64-bit mix.
+constexpr uint64_t
+splitmix64(uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+
+/// Document seed, see set_random_seed.
+std::atomic<uint64_t>&
+random_seed()
+{
+  static std::atomic<uint64_t> seed(0xa60);
+  return seed;
+}
+
+
+/// Counter for default stream indices.
+std::atomic<uint64_t>&
+random_index()
+{
+  static std::atomic<uint64_t> index(0);
+  return index;
+}
+
+
+/// Set document seed and restart default stream numbering.
+void
+set_random_seed(const uint64_t seed)
+{
+  random_seed() = seed;
+  random_index() = 0;
+}
+
+
+/// Next default stream index.
+uint64_t
+next_random_index()
+{ return random_index()++; }
+
+
+/**
+   Random stream keyed by seed and index.
+
+   Meets UniformRandomBitGenerator, so works with the std
+   distributions. The n-th value is splitmix64 of the key plus n
+   times an odd constant, and is also available directly as at(n).
+*/
+struct random_stream
+{
+  using result_type = uint64_t;
+
+  uint64_t	_M_key;
+  uint64_t	_M_counter = 0;
+
+  explicit constexpr
+  random_stream(const uint64_t index, const uint64_t seed)
+  : _M_key(splitmix64(seed ^ splitmix64(index)))
+  { }
+
+  explicit
+  random_stream(const uint64_t index = next_random_index())
+  : random_stream(index, random_seed())
+  { }
+
+  static constexpr result_type
+  min()
+  { return std::numeric_limits<result_type>::min(); }
+
+  static constexpr result_type
+  max()
+  { return std::numeric_limits<result_type>::max(); }
+
+  /// Value n of stream, independent of the current position.
+  constexpr result_type
+  at(const uint64_t n) const
+  { return splitmix64(_M_key + n * 0xd1342543de82ef95ULL); }
+
+  constexpr result_type
+  operator()()
+  { return at(_M_counter++); }
+
+  /// Skip n values.
+  constexpr void
+  discard(const uint64_t n)
+  { _M_counter += n; }
+};
+
+} // namespace svg
+
+#endif
@@ -335,6 +335,27 @@ make_circle(const point_2t origin, const style s,
 }
 
 
+/// Draw circle in obj, as make_circle, without a circle_element.
+void
+point_to_circle(element_base& obj, const point_2t origin, const style s,
+		const space_type r, const string xform = "")
+{
+  string out;
+  circle_writer c(out);
+  auto [ x, y ] = origin;
+  c.start();
+  c.add_data(x, y, r);
+  c.add_transform(xform);
+  c.add_style(s);
+  c.finish();
+
+  bbox b = bbox::centered_at(origin, 2 * r, 2 * r);
+  if (!xform.empty())
+    b = transform_bounds(b, xform);
+  obj.add_markup(out, b, s._M_stroke_size);
+}
+
+
 /// Make circle element with title and tooltip information.
 /// @param origin is the point (x,y) that is the center of the circle
 /// @param s is the visual style
@@ -492,17 +513,19 @@ make_line(const point_2t origin, const point_2t end, style s,
 /// Lines radiating from center point (x,y).
 group_element
 make_line_rays(const point_2t origin, const style s,
-	       const space_type r = 4, const uint nrays = 10)
+	       const space_type r = 4, const uint nrays = 10,
+	       const uint64_t rindex = next_random_index())
 {
   // End points on the ray.
   // Pick a random ray, use an angle in the range [0, 2pi].
-  static std::mt19937_64 rg(std::random_device{}());
+  random_stream rg(rindex);
   auto distr = std::uniform_real_distribution<>(0.0, 2 * 22/7);
   auto disti = std::uniform_int_distribution<>(-3, 3);
   auto [ x, y ] = origin;
 
   group_element g;
   g.start_element("rays-" + std::to_string(nrays) + "-" + std::to_string(r));
+  string rays;
   for (uint i = 0; i < nrays; ++i)
     {
       double theta = distr(rg);
@@ -511,15 +534,13 @@ make_line_rays(const point_2t origin, const style s,
       double xe = x + (r + rvary) * std::cos(theta);
       double ye = y + (r + rvary) * std::sin(theta);
 
-      line_element::data dr = { x, xe, y, ye };
-      line_element ray;
-      ray.start_element();
-      ray.add_data(dr);
+      line_writer ray(rays);
+      ray.start();
+      ray.add_data(x, y, xe, ye);
       ray.add_style(s);
-      ray.finish_element();
-
-      g.add_element(ray);
+      ray.finish();
     }
+  g.add_markup(rays);
   g.finish_element();
   return g;
 }
@@ -747,14 +768,18 @@ make_path_arc_closed(const point_2t& origin, const double startd,
 /// @param origin center of the shape.
 /// @param s style for the polyline
 /// @param size radius of mark
-/// @param numCurves number of curves between 5-8 optimal
+/// @param ncurves number of curves between 5-8 optimal, 0 for random
+/// @param rindex random stream index
 path_element
 make_path_blob(const point_2t origin, const style s, const double size,
-	       const int numCurves = 5 + std::rand() % 4,
-	       const string tipstr = "")
+	       const int ncurves = 0, const string tipstr = "",
+	       const uint64_t rindex = next_random_index())
 {
   auto [ ox, oy ] = origin;
-  std::srand(std::time(0));
+  random_stream rg(rindex);
+  auto distp = std::uniform_int_distribution<>(0, 99);
+  const int numCurves = ncurves > 0 ? ncurves
+				     : 5 + std::uniform_int_distribution<>(0, 3)(rg);
 
   // Generate main points
   vrange points;
@@ -762,7 +787,7 @@ make_path_blob(const point_2t origin, const style s, const double size,
   for (int i = 0; i < numCurves; i++)
     {
       double angle = (2 * k::pi * i) / numCurves;
-      double variation = 0.5 + (std::rand() % 100) / 100.0;
+      double variation = 0.5 + distp(rg) / 100.0;
       double radius = size * variation;
 
       double x = ox + radius * cos(angle);
@@ -771,7 +796,7 @@ make_path_blob(const point_2t origin, const style s, const double size,
 
       // Generate control point for this segment
       double controlAngle = angle + k::pi / numCurves;
-      double controlRadius = size * (0.3 + 0.4 * (std::rand() % 100) / 100.0);
+      double controlRadius = size * (0.3 + 0.4 * distp(rg) / 100.0);
       double cx = ox + controlRadius * cos(controlAngle);
       double cy = oy + controlRadius * sin(controlAngle);
       controlPoints.push_back({cx, cy});
@@ -1142,12 +1167,12 @@ make_text_honeycomb(const point_2t origin, const double r,
   group_element ginner;
   ginner.start_element(gbase + "inner", txrotatepoint);
 
-  auto hexpoints = radiate_hexagon_honeycomb(origin, r, hexn, cfillp);
-  auto hexangles = get_honeycomb_angles(origin, hexpoints, true);
-  for (uint i = 0; !s.empty() && i < hexpoints.size(); i++)
+  for (const honeycomb_cell& cell : honeycomb_cells(origin, r,
+						    s.empty() ? 0 : hexn,
+						    cfillp, true))
     {
-      const auto& p = hexpoints[i];
-      const double d = hexangles[i];
+      const auto& p = cell.center;
+      const double d = cell.angle;
       text_element t = style_text_r(s, p, typo, d, p, k::rrotation::cw);
       //text_element t = style_text_r(s, p, typo, d, origin, k::rrotation::cw);
       ginner.add_element(t);
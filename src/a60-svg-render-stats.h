@@ -0,0 +1,295 @@
+// svg render statistics -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_RENDER_STATS_H
+#define MiL_SVG_RENDER_STATS_H 1
+
+#include <chrono>
+#include <map>
+
+
+namespace svg {
+
+/// Major stages of a render, for timing.
+enum class render_stage
+{
+  transform,		///< Data to points, as transform_to_graph_points.
+  layout,		///< Placement, as radial and honeycomb layout.
+  serialize,		///< Document to markup.
+  write,		///< Markup to file.
+  last
+};
+
+const string
+to_string(const render_stage e)
+{
+  using enum_map_type = std::map<render_stage, std::string>;
+
+  static enum_map_type enum_map;
+  if (enum_map.empty())
+    {
+      enum_map[render_stage::transform] = "transform";
+      enum_map[render_stage::layout] = "layout";
+      enum_map[render_stage::serialize] = "serialize";
+      enum_map[render_stage::write] = "write";
+    }
+  return enum_map[e];
+}
+
+
+/// Memory resource counting allocations passed to upstream.
+struct counting_resource : public std::pmr::memory_resource
+{
+  std::pmr::memory_resource*	_M_upstream;
+  size_t			_M_allocations = 0;
+  size_t			_M_bytes = 0;
+
+  explicit
+  counting_resource(std::pmr::memory_resource* up
+		    = std::pmr::get_default_resource())
+  : _M_upstream(up) { }
+
+private:
+  void*
+  do_allocate(size_t bytes, size_t align) override
+  {
+    ++_M_allocations;
+    _M_bytes += bytes;
+    return _M_upstream->allocate(bytes, align);
+  }
+
+  void
+  do_deallocate(void* p, size_t bytes, size_t align) override
+  { _M_upstream->deallocate(p, bytes, align); }
+
+  bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  { return this == &other; }
+};
+
+
+/**
+   Render statistics for one document.
+
+   Opt in with render_stats_scope, and read after the render, or as
+   JSON with serialize_render_stats_json in izzi-json-basics.h.
+
+   Elements are counted as they are added to a parent, keyed by
+   element name, with the size of their markup. Element bytes include
+   nested elements, so a group counts the bytes of everything in it,
+   and sizes are not additive across names. Groups are also counted
+   by id. Markup from element writers is counted per element.
+
+   Allocations are those of element buffers, through the memory
+   resource of the scope, see get_memory_resource.
+*/
+struct render_stats
+{
+  struct counter
+  {
+    size_t	count = 0;
+    size_t	bytes = 0;
+  };
+
+  using counter_map = std::map<string, counter>;
+  using stage_seconds = std::array<double, size_t(render_stage::last)>;
+
+  counter_map		elements;	///< By element name.
+  counter_map		groups;		///< By group id.
+  stage_seconds		seconds = { };	///< By render_stage.
+  size_t		document_bytes = 0;
+  size_t		culled = 0;	///< Elements dropped, see cull_scope.
+  counting_resource	allocations;
+
+  void
+  clear()
+  {
+    elements.clear();
+    groups.clear();
+    seconds = { };
+    document_bytes = 0;
+    culled = 0;
+    allocations._M_allocations = 0;
+    allocations._M_bytes = 0;
+  }
+
+  /// Name of first element in markup, as "circle", and for groups
+  /// the id if any.
+  static std::pair<string_view, string_view>
+  element_name(string_view s)
+  {
+    const size_t lt = s.find('<');
+    if (lt == string_view::npos)
+      return { };
+    s.remove_prefix(lt + 1);
+    const size_t nend = s.find_first_of(" \t\n/>");
+    const string_view name = s.substr(0, nend);
+
+    string_view id;
+    if (name == "g")
+      {
+	const size_t gt = s.find('>');
+	const size_t idpos = s.substr(0, gt).find("id=\"");
+	if (idpos != string_view::npos)
+	  {
+	    string_view rest = s.substr(idpos + 4);
+	    id = rest.substr(0, rest.find('"'));
+	  }
+      }
+    return { name, id };
+  }
+
+  void
+  count(const string_view name, const string_view id, const size_t bytes)
+  {
+    if (name.empty())
+      return;
+
+    counter& c = elements[string(name)];
+    ++c.count;
+    c.bytes += bytes;
+    if (!id.empty())
+      {
+	counter& g = groups[string(id)];
+	++g.count;
+	g.bytes += bytes;
+      }
+  }
+
+  /// Count element with markup s.
+  void
+  add_element(const string_view s)
+  {
+    auto [ name, id ] = element_name(s);
+    count(name, id, s.size());
+  }
+
+  /// Count each element in markup s of consecutive leaf elements.
+  void
+  add_markup(string_view s)
+  {
+    while (!s.empty())
+      {
+	size_t next = s.find('<', 1);
+	while (next != string_view::npos && next + 1 < s.size()
+	       && (s[next + 1] == '/' || s[next + 1] == '!'))
+	  next = s.find('<', next + 1);
+	add_element(s.substr(0, next));
+	if (next == string_view::npos)
+	  break;
+	s.remove_prefix(next);
+      }
+  }
+
+  void
+  add_time(const render_stage stage, const double secs)
+  { seconds[size_t(stage)] += secs; }
+
+  double
+  total_seconds() const
+  {
+    double ret = 0;
+    for (const double s : seconds)
+      ret += s;
+    return ret;
+  }
+};
+
+
+/// Active render statistics, or nullptr if not collecting.
+render_stats*&
+get_render_stats()
+{
+  static render_stats* stats(nullptr);
+  return stats;
+}
+
+
+/// Set active render statistics, nullptr to turn off collection.
+/// Returns the previous statistics.
+render_stats*
+set_render_stats(render_stats* stats)
+{
+  render_stats*& active = get_render_stats();
+  render_stats* old = active;
+  active = stats;
+  return old;
+}
+
+
+/**
+   Collect statistics into stats for the lifetime of this object, on
+   this thread's element buffers, as:
+
+   render_stats rs;
+   {
+     render_stats_scope scope(rs);
+     svg_element obj(...);
+     ...
+   }
+*/
+struct render_stats_scope
+{
+  render_stats*			_M_old;
+  memory_resource_scope		_M_resource;
+
+  explicit
+  render_stats_scope(render_stats& stats)
+  : _M_old(set_render_stats(&stats)), _M_resource(chain(stats))
+  { }
+
+  ~render_stats_scope()
+  { set_render_stats(_M_old); }
+
+  /// Count allocations in front of the current memory resource.
+  static std::pmr::memory_resource*
+  chain(render_stats& stats)
+  {
+    stats.allocations._M_upstream = get_memory_resource();
+    return &stats.allocations;
+  }
+};
+
+
+/// Add time from construction to destruction to stage, if collecting.
+struct render_stage_timer
+{
+  using clock_type = std::chrono::steady_clock;
+
+  render_stats*		_M_stats;
+  render_stage		_M_stage;
+  clock_type::time_point	_M_start;
+
+  explicit
+  render_stage_timer(const render_stage stage)
+  : _M_stats(get_render_stats()), _M_stage(stage)
+  {
+    if (_M_stats)
+      _M_start = clock_type::now();
+  }
+
+  ~render_stage_timer()
+  {
+    if (_M_stats)
+      {
+	std::chrono::duration<double> d = clock_type::now() - _M_start;
+	_M_stats->add_time(_M_stage, d.count());
+      }
+  }
+};
+
+} // namespace svg
+
+#endif
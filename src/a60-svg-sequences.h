@@ -34,6 +34,7 @@ strings
 fade_to_color_seq(const rect_element::data& dr, const color klr,
 		  size_t fps = 30, double sec = 1.0, double maxopac = 1.0)
 {
+  trace_scope ts("fade_to_color_seq");
   // Calc number of frames needed.
   size_t framesn = fps * sec;
   double step = maxopac / framesn;
@@ -65,6 +66,7 @@ strings
 fade_from_color_seq(const rect_element::data& dr, const color klr,
 		    size_t fps = 30, double sec = 1.0, double minopac = 0)
 {
+  trace_scope ts("fade_from_color_seq");
   strings ret = fade_to_color_seq(dr, klr, fps, sec, minopac);
   std::reverse(ret.begin(), ret.end());
   return ret;
@@ -81,6 +83,7 @@ blink_to_color_seq(const rect_element::data& dr, const color klr,
 		   size_t fps, double sec,
 		   double twhen, size_t nblinks, double blinksec)
 {
+  trace_scope ts("blink_to_color_seq");
   // Calc number of frames needed.
   size_t framesn = fps * sec;
   size_t startn = fps * twhen;
@@ -155,6 +158,7 @@ wink_to_color_seq(const rect_element::data& dr, const color klr,
 		  size_t fps, double sec,
 		  double twhen, double maxclose, double winksec)
 {
+  trace_scope ts("wink_to_color_seq");
   const int rows = dr._M_height;
 
   // Calc number of frames needed.
@@ -272,6 +276,7 @@ vertical_sync_roll_seq(const rect_element::data& drin, const color klr,
 		       size_t /*fps = 30*/, double step = 10,
 		       int blursz = 200, int solidsz = 133, double opac = 0.6)
 {
+  trace_scope ts("vertical_sync_roll_seq");
   // Composition of two rectangular elements:
   // (background) 60 pixel wide rectangular blur 10 pixels, 60% opacity
   // (foreground) 20 pixels wide centered solid color overlay
@@ -359,13 +364,15 @@ dot_grid_seq(const rect_element::data& drin, const color klr,
 	     const rect_element::atype radius = 80,
 	     const int maxwidth = 8, const int maxheight = 4,
 	     const rect_element::atype xstart = 40,
-	     const rect_element::atype ystart = 100)
+	     const rect_element::atype ystart = 100,
+	     const uint64_t rindex = next_random_index())
 {
+  trace_scope ts("dot_grid_seq");
   // 1920x1080 landscape baselines.
   // 8 wide, 4 high
   // 160 pixel diameter, start at x 40, y 100, move 240.
 
-  static std::mt19937_64 rg(std::random_device{}());
+  random_stream rg(rindex);
   auto distw = std::uniform_int_distribution<>(0, maxwidth);
   auto disth = std::uniform_int_distribution<>(0, maxheight);
   auto distb = std::uniform_int_distribution<>(0, 1);
@@ -442,6 +449,7 @@ optical_sound_dots_seq(const rect_element::data& drin, const color klr,
 		       const int maxw = 8, const int maxh = 4,
 		       const int xstart = 40, const int ystart = 100)
 {
+  trace_scope ts("optical_sound_dots_seq");
   strings ret;
   size_t framesn = fps * sec;   // Calc number of frames needed.
   size_t step_size = 4 + 17 + 4;
@@ -476,6 +484,7 @@ strings
 swipe_left_seq(const rect_element::data& drin, const string imgf,
 	       const color klr = color::white, size_t fps = 30, double sec = 9)
 {
+  trace_scope ts("swipe_left_seq");
   using atype = rect_element::atype;
   
   // Watch for horizontal tearing, tricky.
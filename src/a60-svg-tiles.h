@@ -0,0 +1,351 @@
+// svg tiled output -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_TILES_H
+#define MiL_SVG_TILES_H 1
+
+#include <fstream>
+#include <map>
+
+#include "a60-svg.h"
+
+
+namespace svg {
+
+/**
+   Multi-resolution tiled output, for canvases too large to view as
+   one document.
+
+   Elements are collected with their bounding boxes (see
+   a60-svg-culling.h) and layer, then written as a quadtree pyramid of
+   square tile documents of tile_size pixels. Level 0 is one tile
+   holding the whole canvas, and each level after halves the extent of
+   a tile, until one canvas unit is one pixel. Each tile has only the
+   elements that touch it, clipped by a nested svg element, and tiles
+   with no elements are not written.
+
+   Per level, polylines and polygons added as points are simplified to
+   within half a pixel, and elements smaller than min_feature pixels
+   are dropped. Elements of unknown extent, as groups, are in every
+   tile at every level.
+
+   A manifest, name-tiles.json, lists levels and tiles for a viewer:
+
+   {"name":"map","width":W,"height":H,"tile_size":256,"levels":[
+    {"level":0,"scale":S,"tile_extent":E,"columns":1,"rows":1,"tiles":[
+     {"x":0,"y":0,"file":"map-0-0-0.svg","elements":N}]}]}
+
+   Use as:
+   tile_pyramid tp("map", area<>(40000, 20000));
+   tp.add_element(make_circle(p, s, 4), select::cartography);
+   tp.add_polyline(coast, s, { }, select::vector);
+   tp.write();
+*/
+class tile_pyramid
+{
+public:
+  /// How an item is kept, as markup or as points to simplify.
+  enum class shape { markup, polyline, polygon };
+
+  struct item
+  {
+    shape		_M_shape;
+    select		_M_layer;
+    bbox		_M_bounds;	///< Empty if not known.
+    string		_M_markup;
+    vrange		_M_points;
+    style		_M_style;
+    stroke_style	_M_sstyle;
+  };
+
+  using tile_index = std::pair<uint, uint>;
+  using tile_map = std::map<tile_index, std::vector<uint>>;
+
+private:
+  const string		_M_name;
+  const area<>		_M_area;
+  const uint		_M_tile_size;
+  std::vector<item>	_M_items;
+
+public:
+  /// Items smaller than this, in pixels at a level, are not in it.
+  double		_M_min_feature = 0.5;
+
+  tile_pyramid(const string name, const area<> a, const uint tile_size = 256)
+  : _M_name(name), _M_area(a), _M_tile_size(tile_size)
+  {
+    if (tile_size == 0 || a._M_width <= 0 || a._M_height <= 0)
+      {
+	string m("tile_pyramid:: empty canvas or tile for ");
+	m += name;
+	throw std::runtime_error(m);
+      }
+  }
+
+  const std::vector<item>&
+  items() const
+  { return _M_items; }
+
+  /// Add element e, with the bounding box it computed.
+  void
+  add_element(const element_base& e, const select layer = select::vector)
+  {
+    bbox b;
+    if (!e._M_unboundedp && !e._M_bounds.emptyp())
+      b = e._M_bounds.inflate(2 * e._M_stroke_width);
+    add_markup(e.str(), b, layer);
+  }
+
+  /// Add serialized markup with bounding box b, empty if not known.
+  void
+  add_markup(const string_view s, const bbox& b,
+	     const select layer = select::vector)
+  { _M_items.push_back(item { shape::markup, layer, b, string(s), { }, { }, { } }); }
+
+  /// Add polyline, simplified per level.
+  void
+  add_polyline(const vrange& points, const style& s,
+	       const stroke_style& sstyle = { },
+	       const select layer = select::vector)
+  {
+    // Markers reach out by their own size.
+    bbox b;
+    if (sstyle.marker_defs.empty())
+      b = points_bounds(points).inflate(2 * s._M_stroke_size);
+    _M_items.push_back(item { shape::polyline, layer, b, "", points, s, sstyle });
+  }
+
+  /// Add polygon, simplified per level.
+  void
+  add_polygon(const vrange& points, const style& s,
+	      const select layer = select::vector)
+  {
+    const bbox b = points_bounds(points).inflate(2 * s._M_stroke_size);
+    _M_items.push_back(item { shape::polygon, layer, b, "", points, s, { } });
+  }
+
+  /// Canvas units across a tile at level z.
+  double
+  tile_extent(const uint z) const
+  { return std::max(_M_area._M_width, _M_area._M_height) / std::ldexp(1.0, z); }
+
+  /// Pixels per canvas unit at level z.
+  double
+  scale(const uint z) const
+  { return _M_tile_size / tile_extent(z); }
+
+  /// Levels until one canvas unit is at least one pixel.
+  uint
+  levels() const
+  {
+    uint z = 0;
+    while (tile_extent(z) > _M_tile_size)
+      ++z;
+    return z + 1;
+  }
+
+  /// Tiles of level z with the items in them, in document order, for
+  /// items in layers. Items of unknown extent are added to tiles
+  /// with other items.
+  tile_map
+  tiles(const uint z, const select layers = select::all) const
+  {
+    const render_state_base rstate(layers);
+    const double te = tile_extent(z);
+    const double minsize = _M_min_feature / scale(z);
+    const uint columns = std::ceil(_M_area._M_width / te);
+    const uint rows = std::ceil(_M_area._M_height / te);
+    const bbox canvas(0, 0, _M_area._M_width, _M_area._M_height);
+
+    // Tile holding coordinate d, of n tiles.
+    auto index = [te](const double d, const uint n)
+    { return uint(std::clamp(std::floor(d / te), 0.0, double(n - 1))); };
+
+    tile_map ret;
+    std::vector<uint> everywhere;
+    for (uint i = 0; i < _M_items.size(); ++i)
+      {
+	const item& it = _M_items[i];
+	if (!rstate.is_visible(select::all) && !rstate.is_visible(it._M_layer))
+	  continue;
+
+	const bbox& b = it._M_bounds;
+	if (b.emptyp())
+	  {
+	    everywhere.push_back(i);
+	    continue;
+	  }
+	if (!canvas.intersectsp(b)
+	    || std::max(b.width(), b.height()) < minsize)
+	  continue;
+
+	for (uint y = index(b._M_y0, rows); y <= index(b._M_y1, rows); ++y)
+	  for (uint x = index(b._M_x0, columns); x <= index(b._M_x1, columns); ++x)
+	    ret[{ x, y }].push_back(i);
+      }
+
+    if (!everywhere.empty())
+      for (auto& [ idx, v ] : ret)
+	{
+	  std::vector<uint> merged;
+	  merged.reserve(v.size() + everywhere.size());
+	  std::merge(v.begin(), v.end(), everywhere.begin(), everywhere.end(),
+		     std::back_inserter(merged));
+	  v = std::move(merged);
+	}
+    return ret;
+  }
+
+  /// Markup of item i at level z.
+  string
+  markup(const uint i, const uint z) const
+  {
+    const item& it = _M_items[i];
+    const double tolerance = 0.5 / scale(z);
+    switch (it._M_shape)
+      {
+      case shape::polyline:
+	{
+	  const vrange pts = simplify_vrange(it._M_points, tolerance);
+	  return make_polyline(pts, it._M_style, it._M_sstyle).str();
+	}
+      case shape::polygon:
+	{
+	  const vrange pts = simplify_vrange(it._M_points, tolerance);
+	  return make_polygon(pts, it._M_style).str();
+	}
+      default:
+	return it._M_markup;
+      }
+  }
+
+  /// File name, without extension, of tile x, y at level z.
+  string
+  tile_name(const uint z, const uint x, const uint y) const
+  {
+    return _M_name + "-" + std::to_string(z) + "-" + std::to_string(x)
+      + "-" + std::to_string(y);
+  }
+
+  /// Write tile at level z with items.
+  void
+  write_tile(const uint z, const uint x, const uint y,
+	     const std::vector<uint>& items) const
+  {
+    const double s = scale(z);
+    const double te = tile_extent(z);
+    const area<> ta(_M_tile_size, _M_tile_size);
+
+    // Canvas to tile pixels.
+    const double tx = s * x * te;
+    const double ty = s * y * te;
+    string ts("translate(");
+    append_general(ts, tx == 0 ? 0 : -tx, 10);
+    ts += k::comma;
+    append_general(ts, ty == 0 ? 0 : -ty, 10);
+    ts += ") scale(";
+    append_general(ts, s, 10);
+    ts += ")";
+
+    std::vector<string> markups(items.size());
+    for (uint i = 0; i < items.size(); ++i)
+      markups[i] = markup(items[i], z);
+
+    group_element g;
+    g.start_element("tile", ts);
+    for (const string& m : markups)
+      g.add_markup(m);
+    g.finish_element();
+
+    const string name = tile_name(z, x, y);
+    svg_element tile(name, ta, false);
+    tile.start();
+    tile.add_element(nest_inner_element(g, { 0, 0 }, ta, name, false));
+    tile.finish();
+  }
+
+  /**
+     Write tiles for levels, or for levels() if zero, and the manifest.
+     Only items in layers are written.
+     Returns the manifest file name.
+  */
+  string
+  write(uint nlevels = 0, const select layers = select::all) const
+  {
+    trace_scope tsc("tile_pyramid::write");
+    if (nlevels == 0)
+      nlevels = levels();
+
+    const string mfile(_M_name + "-tiles.json");
+    std::ofstream f(mfile);
+    if (!f.good())
+      {
+	string m("tile_pyramid::write:: error opening file ");
+	m += mfile;
+	throw std::runtime_error(m);
+      }
+    f.precision(10);
+
+    auto quoted = [&f](const string& s)
+    {
+      f << k::quote;
+      for (const char c : s)
+	{
+	  if (c == '"' || c == '\\')
+	    f << '\\';
+	  f << c;
+	}
+      f << k::quote;
+    };
+
+    f << "{\"name\":";
+    quoted(_M_name);
+    f << ",\"width\":" << _M_area._M_width
+      << ",\"height\":" << _M_area._M_height
+      << ",\"tile_size\":" << _M_tile_size << ",\"levels\":[";
+    for (uint z = 0; z < nlevels; ++z)
+      {
+	const double te = tile_extent(z);
+	if (z > 0)
+	  f << k::comma;
+	f << k::newline << "{\"level\":" << z << ",\"scale\":" << scale(z)
+	  << ",\"tile_extent\":" << te
+	  << ",\"columns\":" << std::ceil(_M_area._M_width / te)
+	  << ",\"rows\":" << std::ceil(_M_area._M_height / te)
+	  << ",\"tiles\":[";
+
+	bool firstp = true;
+	for (const auto& [ idx, items ] : tiles(z, layers))
+	  {
+	    auto [ x, y ] = idx;
+	    write_tile(z, x, y, items);
+
+	    if (!firstp)
+	      f << k::comma;
+	    firstp = false;
+	    f << k::newline << "{\"x\":" << x << ",\"y\":" << y << ",\"file\":";
+	    quoted(tile_name(z, x, y) + ".svg");
+	    f << ",\"elements\":" << items.size() << "}";
+	  }
+	f << "]}";
+      }
+    f << "]}" << k::newline;
+    return mfile;
+  }
+};
+
+} // namespace svg
+
+#endif
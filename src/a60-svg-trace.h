@@ -0,0 +1,255 @@
+// svg trace events -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef MiL_SVG_TRACE_H
+#define MiL_SVG_TRACE_H 1
+
+#ifdef MiL_SVG_TRACE
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#endif
+
+
+namespace svg {
+
+/**
+   TRACE
+
+   Timeline of render functions as Chrome trace event JSON, for
+   chrome://tracing or ui.perfetto.dev, with one track per thread.
+
+   Place a scope at the start of a function:
+
+   trace_scope ts("make_line_graph");
+
+   Build with MiL_SVG_TRACE defined, for all translation units, to
+   record. Otherwise trace_scope is empty and compiles out.
+
+   Each thread records complete events into its own ring buffer of
+   trace_ring::capacity events, overwriting the oldest. Recording
+   takes no locks. Call write_trace_json after the traced work is
+   done, to export the rings of all threads.
+*/
+#ifdef MiL_SVG_TRACE
+
+/// Nanoseconds since the first trace clock read in the process.
+uint64_t
+trace_clock_ns()
+{
+  using clock_type = std::chrono::steady_clock;
+  static const clock_type::time_point epoch = clock_type::now();
+  auto d = clock_type::now() - epoch;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+
+/// Complete event, a named span of time.
+struct trace_event
+{
+  const char*	name;		///< Static string, not copied.
+  uint64_t	start_ns;
+  uint64_t	duration_ns;
+};
+
+
+/// Per-thread ring of trace events, written only by its thread.
+struct trace_ring
+{
+  static constexpr size_t	capacity = 1 << 16;
+
+  std::array<trace_event, capacity>	_M_events;
+  std::atomic<uint64_t>			_M_head = 0;	///< Events written.
+  uint				_M_tid;
+
+  explicit
+  trace_ring(const uint tid) : _M_tid(tid) { }
+
+  void
+  push(const trace_event& e)
+  {
+    const uint64_t h = _M_head.load(std::memory_order_relaxed);
+    _M_events[h % capacity] = e;
+    _M_head.store(h + 1, std::memory_order_release);
+  }
+};
+
+
+/// All thread rings, kept after their threads exit.
+struct trace_registry
+{
+  std::mutex				_M_mutex;
+  std::vector<std::shared_ptr<trace_ring>>	_M_rings;
+
+  std::shared_ptr<trace_ring>
+  make_ring()
+  {
+    std::lock_guard<std::mutex> lock(_M_mutex);
+    auto ring = std::make_shared<trace_ring>(_M_rings.size() + 1);
+    _M_rings.push_back(ring);
+    return ring;
+  }
+};
+
+
+trace_registry&
+get_trace_registry()
+{
+  static trace_registry registry;
+  return registry;
+}
+
+
+/// Ring of this thread, registered on first use.
+trace_ring&
+get_trace_ring()
+{
+  thread_local std::shared_ptr<trace_ring> ring
+    = get_trace_registry().make_ring();
+  return *ring;
+}
+
+
+/// Record time from construction to destruction as event name.
+struct trace_scope
+{
+  const char*	_M_name;
+  uint64_t	_M_start;
+
+  explicit
+  trace_scope(const char* name)
+  : _M_name(name), _M_start(trace_clock_ns()) { }
+
+  ~trace_scope()
+  {
+    const uint64_t end = trace_clock_ns();
+    get_trace_ring().push(trace_event { _M_name, _M_start, end - _M_start });
+  }
+
+  trace_scope(const trace_scope&) = delete;
+
+  trace_scope&
+  operator=(const trace_scope&) = delete;
+};
+
+
+/// Write events in all rings as Chrome trace event JSON.
+void
+write_trace_json(std::ostream& os)
+{
+  auto escaped = [&os](const char* s)
+  {
+    for (; *s; ++s)
+      {
+	if (*s == '"' || *s == '\\')
+	  os << '\\';
+	os << *s;
+      }
+  };
+
+  // Microseconds with nanosecond fraction.
+  auto us = [&os](const uint64_t ns)
+  {
+    const uint64_t frac = ns % 1000;
+    os << ns / 1000 << '.' << char('0' + frac / 100)
+       << char('0' + frac / 10 % 10) << char('0' + frac % 10);
+  };
+
+  trace_registry& registry = get_trace_registry();
+  std::lock_guard<std::mutex> lock(registry._M_mutex);
+
+  os << "{\"traceEvents\":[";
+  bool firstp = true;
+  for (const auto& ring : registry._M_rings)
+    {
+      if (!firstp)
+	os << k::comma;
+      firstp = false;
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+	 << ring->_M_tid << ",\"args\":{\"name\":\"thread "
+	 << ring->_M_tid << "\"}}";
+
+      const uint64_t head = ring->_M_head.load(std::memory_order_acquire);
+      const uint64_t first = head > trace_ring::capacity
+			     ? head - trace_ring::capacity : 0;
+      for (uint64_t i = first; i < head; ++i)
+	{
+	  const trace_event& e = ring->_M_events[i % trace_ring::capacity];
+	  os << k::comma << k::newline << "{\"name\":\"";
+	  escaped(e.name);
+	  os << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->_M_tid;
+	  os << ",\"ts\":";
+	  us(e.start_ns);
+	  os << ",\"dur\":";
+	  us(e.duration_ns);
+	  os << '}';
+	}
+    }
+  os << "],\"displayTimeUnit\":\"ms\"}" << k::newline;
+}
+
+
+/// Write trace to file, as write_trace_json.
+void
+write_trace_json(const string& ofile)
+{
+  std::ofstream f(ofile);
+  if (!f.good())
+    {
+      string m("write_trace_json:: error opening file ");
+      m += ofile;
+      throw std::runtime_error(m);
+    }
+  write_trace_json(f);
+}
+
+
+/// Drop recorded events in all rings, when no thread is tracing.
+void
+clear_trace()
+{
+  trace_registry& registry = get_trace_registry();
+  std::lock_guard<std::mutex> lock(registry._M_mutex);
+  for (const auto& ring : registry._M_rings)
+    ring->_M_head.store(0, std::memory_order_release);
+}
+
+#else
+
+/// Tracing compiled out, see MiL_SVG_TRACE.
+struct trace_scope
+{
+  explicit constexpr
+  trace_scope(const char*) { }
+};
+
+void
+write_trace_json(std::ostream&)
+{ }
+
+void
+write_trace_json(const string&)
+{ }
+
+void
+clear_trace()
+{ }
+
+#endif
+
+} // namespace svg
+
+#endif
@@ -21,8 +21,11 @@
 #include <algorithm>
 #include <array>
 #include <tuple>
+#include <utility>
 #include <string>
 #include <vector>
+#include <memory>
+#include <memory_resource>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -40,6 +43,72 @@ using strings = std::vector<string>;
 using vstrings = strings;
 using vvstrings = std::vector<strings>;
 
+/**
+   Polymorphic allocator variants of the izzi containers, as std::pmr.
+
+   Construct with a memory resource, such as get_memory_resource(),
+   to allocate from an arena and release it all at once.
+*/
+namespace pmr {
+  using string = std::pmr::string;
+  using strings = std::pmr::vector<string>;
+  using vstrings = strings;
+  using vvstrings = std::pmr::vector<strings>;
+} // namespace pmr
+
+
+/// Memory resource for element buffers made on this thread, see
+/// element_base::retain. Defaults to std::pmr::get_default_resource().
+std::pmr::memory_resource*&
+get_memory_resource()
+{
+  thread_local std::pmr::memory_resource* mr(nullptr);
+  if (!mr)
+    mr = std::pmr::get_default_resource();
+  return mr;
+}
+
+
+/// Set memory resource for this thread, returning the old one.
+std::pmr::memory_resource*
+set_memory_resource(std::pmr::memory_resource* mr)
+{
+  std::pmr::memory_resource*& active = get_memory_resource();
+  std::pmr::memory_resource* old = active;
+  active = mr;
+  return old;
+}
+
+
+/**
+   Use memory resource mr on this thread for the lifetime of this
+   object, as:
+
+   std::pmr::monotonic_buffer_resource arena;
+   {
+     memory_resource_scope scope(&arena);
+     svg_element obj(...);
+     ...
+   }
+   // arena released in one step when it goes out of scope.
+*/
+struct memory_resource_scope
+{
+  std::pmr::memory_resource*	_M_old;
+
+  explicit
+  memory_resource_scope(std::pmr::memory_resource* mr)
+  : _M_old(set_memory_resource(mr)) { }
+
+  ~memory_resource_scope()
+  { set_memory_resource(_M_old); }
+
+  memory_resource_scope(const memory_resource_scope&) = delete;
+
+  memory_resource_scope&
+  operator=(const memory_resource_scope&) = delete;
+};
+
 /// Durational searching and sorting.
 using sstrings = std::set<string>;
 using msstrings = std::multiset<string>;
@@ -152,6 +221,8 @@ namespace k = constants;
 } // namespace svg
 
 
+#include "a60-svg-random.h"			// random_stream
+#include "a60-svg-number-format.h"		// number_format
 #include "a60-svg-color.h"			// color, color_qi, color_qf
 #include "a60-svg-color-palette.h"
 #include "a60-svg-color-band.h"
@@ -159,6 +230,12 @@ namespace k = constants;
 #include "izzi-points.h"	     // 2d-points, range, distance
 #include "a60-svg-base-types.h"	     // area, style, filter, transform, typography
 #include "a60-svg-constants.h"
+#include "a60-svg-document-tree.h"      // document_tree, retained mode
+#include "a60-svg-probes.h"             // MiL_SVG_PROBE1
+#include "a60-svg-trace.h"              // trace_scope
+#include "a60-svg-render-stats.h"       // render_stats
+#include "a60-svg-element-writers.h"    // circle_writer, line_writer
+#include "a60-svg-culling.h"            // bbox of transforms, paths, text
 #include "a60-svg-elements.h"
 #include "a60-svg-elements-components.h"
 #include "a60-svg-render-state.h"
@@ -0,0 +1,357 @@
+// izzi on-disk dataset cache  -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef izzi_DATA_CACHE_H
+#define izzi_DATA_CACHE_H 1
+
+#include "a60-svg.h"
+#include "izzi-dsv.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+namespace svg {
+
+/// Hash of byte sequence, eight bytes at a time.
+/// Stable across runs, used to detect changed cache sources.
+uint64_t
+hash_bytes(string_view sv, uint64_t h = 0xcbf29ce484222325ULL)
+{
+  constexpr uint64_t prime = 0x100000001b3ULL;
+  size_t i = 0;
+  for (; i + 8 <= sv.size(); i += 8)
+    {
+      uint64_t w;
+      std::memcpy(&w, sv.data() + i, 8);
+      h = (h ^ w) * prime;
+      h ^= h >> 32;
+    }
+  for (; i < sv.size(); ++i)
+    h = (h ^ static_cast<unsigned char>(sv[i])) * prime;
+
+  // Final avalanche.
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+
+/// Binary columnar cache of parsed datasets, one file per dataset.
+///
+/// Entries are keyed by source file and a caller-supplied key that
+/// names what was extracted from it, usually JSON pointer plus field
+/// names. Each entry records a hash of the source contents, and is
+/// ignored when the source no longer matches. Entries written by a
+/// different format version are ignored too.
+///
+/// Layout: cache_header, key bytes, padding to 8, then columns of
+/// native doubles: x values then y values. Named ranges add count + 1
+/// name offsets and the name bytes.
+class dataset_cache
+{
+public:
+  static constexpr uint32_t	version = 1;
+
+  enum class kind : uint32_t { vrange = 1, vspace = 2, vrangenamed = 3 };
+
+  struct cache_header
+  {
+    char	magic[4];
+    uint32_t	version;
+    uint32_t	kind;
+    uint32_t	keysize;
+    uint64_t	source_hash;
+    uint64_t	count;
+    uint64_t	blobsize;
+  };
+
+private:
+  string	_M_dir;
+
+  static constexpr char	magic[4] = { 'i', 'z', 'z', 'c' };
+
+  static size_t
+  pad8(const size_t n)
+  { return (n + 7) & ~size_t(7); }
+
+  /// Cache file for source + key.
+  string
+  entry_path(const string& src, const string& key) const
+  {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const string asrc = fs::absolute(src, ec).string();
+    std::ostringstream oss;
+    oss << std::hex << hash_bytes(key, hash_bytes(asrc)) << ".izc";
+    return (fs::path(_M_dir) / oss.str()).string();
+  }
+
+  /// Map entry and check header against expected values. On success,
+  /// returns offset of first column.
+  size_t
+  open_entry(const mapped_file& mf, const string& key, const kind kd,
+	     const uint64_t srchash, cache_header& hdr) const
+  {
+    string_view in = mf.view();
+    if (in.size() < sizeof(cache_header))
+      return 0;
+
+    std::memcpy(&hdr, in.data(), sizeof(cache_header));
+    if (std::memcmp(hdr.magic, magic, 4) != 0 || hdr.version != version
+	|| hdr.kind != static_cast<uint32_t>(kd) || hdr.source_hash != srchash
+	|| hdr.keysize != key.size())
+      return 0;
+
+    const size_t keyoff = sizeof(cache_header);
+    if (in.size() < keyoff + key.size()
+	|| in.substr(keyoff, key.size()) != key)
+      return 0;
+
+    return pad8(keyoff + key.size());
+  }
+
+  /// Write header and key, then body via writef, to a temporary that
+  /// is renamed over the entry so readers never see partial files.
+  template<typename _Fn>
+  void
+  write_entry(const string& src, const string& key, const kind kd,
+	      const uint64_t srchash, const uint64_t count,
+	      const uint64_t blobsize, _Fn writef) const
+  {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(_M_dir, ec);
+
+    const string fname = entry_path(src, key);
+    const string tname = fname + ".tmp";
+    {
+      std::ofstream ofs(tname, std::ios::binary | std::ios::trunc);
+      if (!ofs.good())
+	return;
+
+      cache_header hdr { { }, version, static_cast<uint32_t>(kd),
+			 static_cast<uint32_t>(key.size()), srchash,
+			 count, blobsize };
+      std::memcpy(hdr.magic, magic, 4);
+      ofs.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+      ofs.write(key.data(), key.size());
+      const size_t padn = pad8(sizeof(hdr) + key.size())
+	- (sizeof(hdr) + key.size());
+      const char zeros[8] = { };
+      ofs.write(zeros, padn);
+      writef(ofs);
+      if (!ofs.good())
+	{
+	  ofs.close();
+	  fs::remove(tname, ec);
+	  return;
+	}
+    }
+    fs::rename(tname, fname, ec);
+  }
+
+  static void
+  write_doubles(std::ostream& os, const vspace& v)
+  {
+    os.write(reinterpret_cast<const char*>(v.data()),
+	     v.size() * sizeof(space_type));
+  }
+
+  static void
+  split_columns(const vrange& vr, vspace& xs, vspace& ys)
+  {
+    xs.reserve(vr.size());
+    ys.reserve(vr.size());
+    for (const point_2t& pt : vr)
+      {
+	xs.push_back(std::get<0>(pt));
+	ys.push_back(std::get<1>(pt));
+      }
+  }
+
+  static void
+  join_columns(const char* xp, const char* yp, const size_t n, vrange& vr)
+  {
+    vr.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      {
+	space_type x, y;
+	std::memcpy(&x, xp + i * sizeof(space_type), sizeof(space_type));
+	std::memcpy(&y, yp + i * sizeof(space_type), sizeof(space_type));
+	vr[i] = std::make_tuple(x, y);
+      }
+  }
+
+public:
+  explicit
+  dataset_cache(const string& dir = ".izzi-cache") : _M_dir(dir) { }
+
+  const string&
+  directory() const
+  { return _M_dir; }
+
+  /// Hash of source file contents, or 0 if it cannot be read.
+  static uint64_t
+  source_hash(const string& src)
+  {
+    mapped_file mf(src);
+    return mf.good() ? hash_bytes(mf.view()) : 0;
+  }
+
+  bool
+  load(const string& src, const string& key, const uint64_t srchash,
+       vrange& out) const
+  {
+    mapped_file mf(entry_path(src, key));
+    cache_header hdr;
+    const size_t off = open_entry(mf, key, kind::vrange, srchash, hdr);
+    if (!off)
+      return false;
+
+    const size_t colsz = hdr.count * sizeof(space_type);
+    if (mf.view().size() < off + 2 * colsz)
+      return false;
+
+    const char* base = mf.view().data() + off;
+    join_columns(base, base + colsz, hdr.count, out);
+    return true;
+  }
+
+  bool
+  load(const string& src, const string& key, const uint64_t srchash,
+       vspace& out) const
+  {
+    mapped_file mf(entry_path(src, key));
+    cache_header hdr;
+    const size_t off = open_entry(mf, key, kind::vspace, srchash, hdr);
+    if (!off)
+      return false;
+
+    const size_t colsz = hdr.count * sizeof(space_type);
+    if (mf.view().size() < off + colsz)
+      return false;
+
+    out.resize(hdr.count);
+    std::memcpy(out.data(), mf.view().data() + off, colsz);
+    return true;
+  }
+
+  bool
+  load(const string& src, const string& key, const uint64_t srchash,
+       vrangenamed& out) const
+  {
+    mapped_file mf(entry_path(src, key));
+    cache_header hdr;
+    const size_t off = open_entry(mf, key, kind::vrangenamed, srchash, hdr);
+    if (!off)
+      return false;
+
+    const size_t colsz = hdr.count * sizeof(space_type);
+    const size_t offsz = (hdr.count + 1) * sizeof(uint64_t);
+    if (mf.view().size() < off + 2 * colsz + offsz + hdr.blobsize)
+      return false;
+
+    const char* base = mf.view().data() + off;
+    vrange vr;
+    join_columns(base, base + colsz, hdr.count, vr);
+
+    const char* offp = base + 2 * colsz;
+    const char* blob = offp + offsz;
+    out.clear();
+    out.reserve(hdr.count);
+    uint64_t b, e;
+    std::memcpy(&b, offp, sizeof(uint64_t));
+    for (size_t i = 0; i < hdr.count; ++i)
+      {
+	std::memcpy(&e, offp + (i + 1) * sizeof(uint64_t), sizeof(uint64_t));
+	if (e < b || e > hdr.blobsize)
+	  return false;
+	out.push_back(std::make_tuple(string(blob + b, e - b), vr[i]));
+	b = e;
+      }
+    return true;
+  }
+
+  void
+  store(const string& src, const string& key, const uint64_t srchash,
+	const vrange& vr) const
+  {
+    vspace xs, ys;
+    split_columns(vr, xs, ys);
+    write_entry(src, key, kind::vrange, srchash, vr.size(), 0,
+		[&](std::ostream& os)
+		{
+		  write_doubles(os, xs);
+		  write_doubles(os, ys);
+		});
+  }
+
+  void
+  store(const string& src, const string& key, const uint64_t srchash,
+	const vspace& vs) const
+  {
+    write_entry(src, key, kind::vspace, srchash, vs.size(), 0,
+		[&](std::ostream& os) { write_doubles(os, vs); });
+  }
+
+  void
+  store(const string& src, const string& key, const uint64_t srchash,
+	const vrangenamed& vrn) const
+  {
+    vrange vr;
+    std::vector<uint64_t> offsets(1, 0);
+    string blob;
+    for (const auto& [ name, pt ] : vrn)
+      {
+	vr.push_back(pt);
+	blob += name;
+	offsets.push_back(blob.size());
+      }
+
+    vspace xs, ys;
+    split_columns(vr, xs, ys);
+    write_entry(src, key, kind::vrangenamed, srchash, vrn.size(),
+		blob.size(), [&](std::ostream& os)
+		{
+		  write_doubles(os, xs);
+		  write_doubles(os, ys);
+		  os.write(reinterpret_cast<const char*>(offsets.data()),
+			   offsets.size() * sizeof(uint64_t));
+		  os.write(blob.data(), blob.size());
+		});
+  }
+
+  /// Return cached value for source + key, or call makef to produce
+  /// it and store the result. Sources that cannot be read are never
+  /// cached.
+  template<typename _Tp, typename _Fn>
+  _Tp
+  get(const string& src, const string& key, _Fn makef) const
+  {
+    _Tp ret;
+    const uint64_t srchash = source_hash(src);
+    if (srchash && load(src, key, srchash, ret))
+      return ret;
+
+    ret = makef();
+    if (srchash)
+      store(src, key, srchash, ret);
+    return ret;
+  }
+};
+
+} // namespace svg
+#endif
@@ -0,0 +1,285 @@
+// izzi delimiter-separated values  -*- mode: C++ -*-
+
+// Copyright (c) 2026, Benjamin De Kosnik <b.dekosnik@gmail.com>
+
+// This file is part of the alpha60 library.  This library is free
+// software; you can redistribute it and/or modify it under the terms
+// of the GNU General Public License as published by the Free Software
+// Foundation; either version 3, or (at your option) any later
+// version.
+
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+
+#ifndef izzi_DSV_H
+#define izzi_DSV_H 1
+
+#include "a60-svg.h"
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace svg {
+
+/// Fields of one DSV row, viewing the underlying buffer.
+using string_views = std::vector<string_view>;
+
+
+/// Read-only memory map of an entire file.
+///
+/// Move-only. Views taken from view() are valid for the lifetime of
+/// the map. Empty files map to an empty view.
+class mapped_file
+{
+private:
+  const char*	_M_data = nullptr;
+  size_t	_M_size = 0;
+  bool		_M_goodp = false;
+
+public:
+  explicit
+  mapped_file(const string& fname)
+  {
+    const int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+
+    struct stat sb;
+    if (::fstat(fd, &sb) == 0)
+      {
+	_M_size = static_cast<size_t>(sb.st_size);
+	_M_goodp = true;
+	if (_M_size > 0)
+	  {
+	    void* p = ::mmap(nullptr, _M_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (p != MAP_FAILED)
+	      {
+		::madvise(p, _M_size, MADV_SEQUENTIAL);
+		_M_data = static_cast<const char*>(p);
+	      }
+	    else
+	      {
+		_M_size = 0;
+		_M_goodp = false;
+	      }
+	  }
+      }
+    ::close(fd);
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept
+  : _M_data(other._M_data), _M_size(other._M_size), _M_goodp(other._M_goodp)
+  {
+    other._M_data = nullptr;
+    other._M_size = 0;
+    other._M_goodp = false;
+  }
+
+  ~mapped_file()
+  {
+    if (_M_data)
+      ::munmap(const_cast<char*>(_M_data), _M_size);
+  }
+
+  bool
+  good() const
+  { return _M_goodp; }
+
+  string_view
+  view() const
+  { return string_view(_M_data, _M_size); }
+};
+
+
+/// Tokenizer for delimiter-separated values over a caller-owned
+/// buffer, usually a mapped_file view.
+///
+/// Fields are string_views into the buffer, so nothing is copied.
+/// Rows end at LF or CRLF. Fields may be quoted: quoted fields can
+/// hold delimiters and newlines, and are returned without the outer
+/// quotes. Doubled quotes inside are left as is, see dsv_unquote.
+///
+/// Delimiters are found with memchr, which glibc vectorizes. Rows
+/// without a quote character take this path. Only rows with quotes
+/// fall back to a byte at a time scan.
+class dsv_reader
+{
+private:
+  string_view	_M_in;
+  size_t	_M_pos = 0;
+  char		_M_delim;
+  char		_M_quote;
+
+  static const char*
+  find(const char* first, const char* last, const char c)
+  {
+    const void* p = std::memchr(first, c, last - first);
+    return p ? static_cast<const char*>(p) : last;
+  }
+
+  static string_view
+  trim_cr(string_view sv)
+  {
+    if (!sv.empty() && sv.back() == '\r')
+      sv.remove_suffix(1);
+    return sv;
+  }
+
+public:
+  dsv_reader(string_view in, const char delim = k::comma,
+	     const char quote = '"')
+  : _M_in(in), _M_delim(delim), _M_quote(quote)
+  { }
+
+  bool
+  done() const
+  { return _M_pos >= _M_in.size(); }
+
+  /// Read the next row into fields. Returns false at end of input.
+  bool
+  next_row(string_views& fields)
+  {
+    fields.clear();
+    if (done())
+      return false;
+
+    const char* base = _M_in.data();
+    const char* first = base + _M_pos;
+    const char* last = base + _M_in.size();
+    const char* eol = find(first, last, '\n');
+
+    if (find(first, eol, _M_quote) == eol)
+      {
+	// Fast path, no quotes in row.
+	const char* f = first;
+	const char* d = find(f, eol, _M_delim);
+	while (d != eol)
+	  {
+	    fields.push_back(string_view(f, d - f));
+	    f = d + 1;
+	    d = find(f, eol, _M_delim);
+	  }
+	fields.push_back(trim_cr(string_view(f, eol - f)));
+	_M_pos = eol - base + (eol != last);
+	return true;
+      }
+
+    // Quoted fields, which may span lines.
+    const char* p = first;
+    while (true)
+      {
+	if (p != last && *p == _M_quote)
+	  {
+	    const char* start = ++p;
+	    while (p != last)
+	      {
+		if (*p == _M_quote)
+		  {
+		    if (p + 1 != last && p[1] == _M_quote)
+		      p += 2;
+		    else
+		      break;
+		  }
+		else
+		  ++p;
+	      }
+	    fields.push_back(string_view(start, p - start));
+	    if (p != last)
+	      ++p;
+
+	    // Skip anything between closing quote and delimiter.
+	    while (p != last && *p != _M_delim && *p != '\n')
+	      ++p;
+	  }
+	else
+	  {
+	    const char* start = p;
+	    while (p != last && *p != _M_delim && *p != '\n')
+	      ++p;
+	    fields.push_back(trim_cr(string_view(start, p - start)));
+	  }
+
+	if (p == last || *p == '\n')
+	  break;
+	++p;
+      }
+    _M_pos = p - base + (p != last);
+    return true;
+  }
+};
+
+
+/// Copy quoted field value, collapsing doubled quotes.
+string
+dsv_unquote(string_view sv, const char quote = '"')
+{
+  string ret;
+  ret.reserve(sv.size());
+  for (size_t i = 0; i < sv.size(); ++i)
+    {
+      ret += sv[i];
+      if (sv[i] == quote && i + 1 < sv.size() && sv[i + 1] == quote)
+	++i;
+    }
+  return ret;
+}
+
+
+/// Convert field to number with from_chars, or return dflt if the
+/// field is empty or not a number. Leading spaces are skipped.
+template<typename _Tp>
+_Tp
+dsv_to_number(string_view sv, const _Tp dflt = _Tp())
+{
+  while (!sv.empty() && sv.front() == k::space)
+    sv.remove_prefix(1);
+
+  _Tp ret(dflt);
+  auto [ ptr, ec ] = std::from_chars(sv.data(), sv.data() + sv.size(), ret);
+  if (ec != std::errc())
+    ret = dflt;
+  return ret;
+}
+
+
+/// Extract one numeric column of a DSV file.
+///
+/// @param fin input file
+/// @param column zero-based column index, rows without it are skipped
+/// @param headerp skip first row
+template<typename _Tp = space_type>
+std::vector<_Tp>
+extract_dsv_column(const string& fin, const size_t column,
+		   const char delim = k::comma, const bool headerp = false)
+{
+  mapped_file mf(fin);
+  if (!mf.good())
+    {
+      string m("extract_dsv_column:: cannot open input file (");
+      m += fin + ")";
+      throw std::runtime_error(m);
+    }
+
+  std::vector<_Tp> ret;
+  dsv_reader reader(mf.view(), delim);
+  string_views fields;
+  if (headerp)
+    reader.next_row(fields);
+  while (reader.next_row(fields))
+    if (column < fields.size())
+      ret.push_back(dsv_to_number<_Tp>(fields[column]));
+  return ret;
+}
+
+} // namespace svg
+#endif
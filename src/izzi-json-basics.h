@@ -17,6 +17,11 @@
 #define izzi_JSON_BASICS_H 1
 
 #include "a60-svg.h"
+#include "izzi-dsv.h"
+#include "izzi-data-cache.h"
+#include <cstdio>
+#include <functional>
+#include <memory>
 #include <iostream>
 #include <fstream>
 
@@ -73,13 +78,77 @@ serialize_id_types_json(jsonstream& writer, const auto& ids, const string tag)
 }
 
 
+/// Serialize render statistics, see render_stats.
+void
+serialize_render_stats_json(jsonstream& writer, const render_stats& rs)
+{
+  auto counters = [&](const string tag, const render_stats::counter_map& m)
+  {
+    writer.String(tag);
+    writer.StartObject();
+    for (const auto& [ name, c ] : m)
+      {
+	writer.String(name);
+	writer.StartObject();
+	writer.String("count");
+	writer.Uint64(c.count);
+	writer.String("bytes");
+	writer.Uint64(c.bytes);
+	writer.EndObject();
+      }
+    writer.EndObject();
+  };
+
+  writer.StartObject();
+  counters("elements", rs.elements);
+  counters("groups", rs.groups);
+
+  writer.String("seconds");
+  writer.StartObject();
+  for (size_t i = 0; i < rs.seconds.size(); ++i)
+    {
+      writer.String(to_string(render_stage(i)));
+      writer.Double(rs.seconds[i]);
+    }
+  writer.EndObject();
+
+  writer.String("allocations");
+  writer.StartObject();
+  writer.String("count");
+  writer.Uint64(rs.allocations._M_allocations);
+  writer.String("bytes");
+  writer.Uint64(rs.allocations._M_bytes);
+  writer.EndObject();
+
+  writer.String("document_bytes");
+  writer.Uint64(rs.document_bytes);
+  writer.String("culled");
+  writer.Uint64(rs.culled);
+  writer.EndObject();
+}
+
+
+/// Render statistics as a JSON string.
+string
+render_stats_to_json(const render_stats& rs)
+{
+  rj::StringBuffer sb;
+  jsonstream writer(sb);
+  serialize_render_stats_json(writer, rs);
+  return sb.GetString();
+}
+
+
 /// Deserialize input string.
 rj::Document
 deserialize_json_string_to_dom(const string& json)
 {
   // DOM
+  MiL_SVG_PROBE1(json__parse__begin, "");
+  probe_timer pt;
   rj::Document dom;
   dom.Parse(json.c_str());
+  MiL_SVG_PROBE3(json__parse__end, "", json.size(), pt.elapsed_ns());
   if (dom.HasParseError())
     {
       std::cerr << "error: cannot parse input string " << std::endl;
@@ -199,10 +268,409 @@ extract_dom_value_to_double(const rj::Value& v)
 }
 
 
+/// Split a JSON pointer (RFC 6901) into unescaped reference tokens.
+/// An empty pointer refers to the document root.
+strings
+split_json_pointer(const string& jpointer)
+{
+  strings tokens;
+  if (!jpointer.empty() && jpointer[0] == '/')
+    {
+      string token;
+      for (size_t i = 1; i <= jpointer.size(); ++i)
+	{
+	  if (i == jpointer.size() || jpointer[i] == '/')
+	    {
+	      tokens.push_back(token);
+	      token.clear();
+	    }
+	  else if (jpointer[i] == '~' && i + 1 < jpointer.size())
+	    {
+	      const char esc = jpointer[++i];
+	      token += esc == '1' ? '/' : esc == '0' ? '~' : esc;
+	    }
+	  else
+	    token += jpointer[i];
+	}
+    }
+  return tokens;
+}
+
+
+/// One series to extract from a JSON array of objects.
+struct json_series_spec
+{
+  string	pointer;	///< JSON pointer to array.
+  string	fieldx;		///< Member name of x value in each object.
+  string	fieldy;		///< Member name of y value in each object.
+};
+
+using json_series_specs = std::vector<json_series_spec>;
+
+
+/// SAX handler that streams values out of one or more locations in a
+/// JSON document without building a DOM.
+///
+/// Each target is named by JSON pointer. If a target is an array of
+/// objects, each element with both x and y fields is passed to
+/// on_point as it is read, with the same coercions as
+/// extract_dom_value_to_double. If a target is an object and on_key
+/// is set, each member name is passed to on_key.
+///
+/// Callbacks get the index of the target in the constructor
+/// argument. Parsing stops as soon as all targets have been read.
+struct json_series_handler
+: public rj::BaseReaderHandler<rj::UTF8<>, json_series_handler>
+{
+  using point_fn = std::function<void(const size_t, const point_2t&)>;
+  using key_fn = std::function<void(const size_t, const string&)>;
+  using missing_fn = std::function<void(const size_t, const size_t)>;
+  using indices = std::vector<size_t>;
+
+  /// Location to extract, with state for current array element.
+  struct target
+  {
+    strings	tokens;
+    string	fieldx;
+    string	fieldy;
+    bool	donep = false;
+
+    double	x = 0;
+    double	y = 0;
+    bool	xp = false;
+    bool	yp = false;
+
+    /// Stack depth of the target container, counting the root as one.
+    size_t
+    depth() const
+    { return tokens.size() + 1; }
+  };
+
+  /// Open container on the current path.
+  struct frame
+  {
+    bool	arrayp;
+    size_t	index;		///< Next element index, if array.
+    string	key;		///< Last member name, if object.
+    indices	onpath;		///< Targets with path from root through here.
+    indices	elementof;	///< Targets with this as array element.
+  };
+
+  std::vector<target>	_M_targets;
+  point_fn		_M_on_point;
+  key_fn		_M_on_key;
+  missing_fn		_M_on_missing;
+
+  std::vector<frame>	_M_stack;
+  size_t		_M_ndone = 0;
+
+  json_series_handler(const json_series_specs& specs, point_fn onpoint,
+		      missing_fn onmissing = nullptr)
+  : _M_on_point(onpoint), _M_on_missing(onmissing)
+  {
+    for (const json_series_spec& spec : specs)
+      {
+	target t;
+	t.tokens = split_json_pointer(spec.pointer);
+	t.fieldx = spec.fieldx;
+	t.fieldy = spec.fieldy;
+	_M_targets.push_back(t);
+      }
+  }
+
+  json_series_handler(const string& jpointer, key_fn onkey)
+  : _M_on_key(onkey)
+  {
+    target t;
+    t.tokens = split_json_pointer(jpointer);
+    _M_targets.push_back(t);
+  }
+
+  bool
+  done() const
+  { return _M_ndone == _M_targets.size(); }
+
+  /// Current container is target i itself.
+  bool
+  is_target(const size_t i) const
+  { return _M_stack.size() == _M_targets[i].depth(); }
+
+  /// Record value for each open target array element if the current
+  /// member name is one of its fields.
+  void
+  field(const double d)
+  {
+    if (_M_stack.empty())
+      return;
+
+    const frame& top = _M_stack.back();
+    for (const size_t i : top.elementof)
+      {
+	target& t = _M_targets[i];
+	if (!t.xp && top.key == t.fieldx)
+	  {
+	    t.x = d;
+	    t.xp = true;
+	  }
+	if (!t.yp && top.key == t.fieldy)
+	  {
+	    t.y = d;
+	    t.yp = true;
+	  }
+      }
+  }
+
+  /// Called after each complete scalar value.
+  void
+  value_end()
+  {
+    if (!_M_stack.empty() && _M_stack.back().arrayp)
+      {
+	// Scalar element of target array: no fields present.
+	frame& top = _M_stack.back();
+	for (const size_t i : top.onpath)
+	  if (is_target(i) && _M_on_missing && _M_on_point)
+	    _M_on_missing(i, top.index);
+	++top.index;
+      }
+  }
+
+  bool
+  scalar(const double d)
+  {
+    field(d);
+    value_end();
+    return true;
+  }
+
+  void
+  push(const bool arrayp)
+  {
+    // Default for a container-valued field, as for the DOM version.
+    field(0.00123);
+
+    frame f { arrayp, 0, "", { }, { } };
+    const size_t depth = _M_stack.size();
+    if (depth == 0)
+      {
+	for (size_t i = 0; i < _M_targets.size(); ++i)
+	  if (!_M_targets[i].donep)
+	    f.onpath.push_back(i);
+      }
+    else
+      {
+	const frame& parent = _M_stack.back();
+	const string token = parent.arrayp ? std::to_string(parent.index)
+					   : parent.key;
+	for (const size_t i : parent.onpath)
+	  {
+	    target& t = _M_targets[i];
+	    if (t.donep)
+	      continue;
+	    if (depth < t.depth() && token == t.tokens[depth - 1])
+	      f.onpath.push_back(i);
+	    if (depth == t.depth() && parent.arrayp && !arrayp)
+	      {
+		f.elementof.push_back(i);
+		t.xp = false;
+		t.yp = false;
+	      }
+	  }
+      }
+    _M_stack.push_back(std::move(f));
+  }
+
+  bool
+  pop()
+  {
+    frame& top = _M_stack.back();
+    for (const size_t i : top.elementof)
+      {
+	const target& t = _M_targets[i];
+	const size_t j = _M_stack[_M_stack.size() - 2].index;
+	if (t.xp && t.yp)
+	  _M_on_point(i, std::make_tuple(t.x, t.y));
+	else if (_M_on_missing)
+	  _M_on_missing(i, j);
+      }
+
+    // Only the first match of each target is read, as with rj::Pointer.
+    for (const size_t i : top.onpath)
+      if (is_target(i) && !_M_targets[i].donep)
+	{
+	  _M_targets[i].donep = true;
+	  ++_M_ndone;
+	}
+    _M_stack.pop_back();
+
+    if (!_M_stack.empty())
+      {
+	frame& parent = _M_stack.back();
+	if (parent.arrayp)
+	  ++parent.index;
+	std::erase_if(parent.onpath, [this](const size_t i)
+		      { return _M_targets[i].donep; });
+      }
+
+    // Stop the parse once all targets are complete.
+    return !done();
+  }
+
+  bool Null() { return scalar(0.00123); }
+  bool Bool(bool b) { return scalar(static_cast<double>(b)); }
+  bool Int(int i) { return scalar(i); }
+  bool Uint(unsigned u) { return scalar(u); }
+  bool Int64(int64_t i) { return scalar(static_cast<double>(i)); }
+  bool Uint64(uint64_t u) { return scalar(static_cast<double>(u)); }
+  bool Double(double d) { return scalar(d); }
+
+  bool
+  String(const char* str, rj::SizeType len, bool)
+  {
+    if (!_M_stack.empty())
+      {
+	const frame& top = _M_stack.back();
+	for (const size_t i : top.elementof)
+	  {
+	    const target& t = _M_targets[i];
+	    if ((!t.xp && top.key == t.fieldx) || (!t.yp && top.key == t.fieldy))
+	      return scalar(std::stod(string(str, len)));
+	  }
+      }
+    value_end();
+    return true;
+  }
+
+  bool
+  StartObject()
+  {
+    push(false);
+    return true;
+  }
+
+  bool
+  Key(const char* str, rj::SizeType len, bool)
+  {
+    frame& top = _M_stack.back();
+    top.key.assign(str, len);
+    if (_M_on_key)
+      for (const size_t i : top.onpath)
+	if (is_target(i))
+	  _M_on_key(i, top.key);
+    return true;
+  }
+
+  bool
+  EndObject(rj::SizeType)
+  { return pop(); }
+
+  bool
+  StartArray()
+  {
+    push(true);
+    return true;
+  }
+
+  bool
+  EndArray(rj::SizeType)
+  { return pop(); }
+};
+
+
+/// Stream input file through SAX handler in fixed size chunks.
+/// Returns false if the file cannot be opened or the parse fails
+/// before the handler has finished.
+bool
+deserialize_json_sax(const string jdata, json_series_handler& handler)
+{
+  // Closed on all paths, including exceptions thrown by the handler.
+  std::unique_ptr<std::FILE, int(*)(std::FILE*)>
+    fp(std::fopen(jdata.c_str(), "rb"), std::fclose);
+  if (!fp)
+    {
+      std::cerr << "error: cannot open input file " << jdata << std::endl;
+      return false;
+    }
+
+  char buffer[65536];
+  rj::FileReadStream is(fp.get(), buffer, sizeof(buffer));
+  rj::Reader reader;
+  MiL_SVG_PROBE1(json__parse__begin, jdata.c_str());
+  probe_timer pt;
+  rj::ParseResult ok = reader.Parse(is, handler);
+  MiL_SVG_PROBE3(json__parse__end, jdata.c_str(), is.Tell(), pt.elapsed_ns());
+
+  if (!ok && !handler.done())
+    {
+      std::cerr << "error: cannot parse input file " << jdata << std::endl;
+      std::cerr << rj::GetParseError_En(ok.Code()) << std::endl;
+      std::cerr << ok.Offset() << std::endl;
+      return false;
+    }
+  return true;
+}
+
+
+/// Stream json arrays named in specs, passing each (fieldx, fieldy)
+/// pair and the index of its spec to onpoint as it is parsed. All
+/// series come from one pass over the input, and memory use is
+/// independent of input size.
+///
+/// jdata == input is path + filename of input JSON data file
+/// specs == array pointer, x field, y field for each series
+/// verbosep == throw if an array element is missing either field
+bool
+stream_json_array_object_field_n(const string jdata,
+				 const json_series_specs& specs,
+				 json_series_handler::point_fn onpoint,
+				 const bool verbosep = true)
+{
+  auto onmissing = [verbosep, &specs](const size_t i, const size_t j)
+  {
+    string m("deserialize_json_array_object_field_n:: error ");
+    m += k::tab;
+    m += specs[i].pointer + k::space;
+    m += "iteration " + std::to_string(j);
+    m += " not found";
+    m += k::newline;
+
+    if (verbosep)
+      throw std::runtime_error(m);
+  };
+
+  json_series_handler handler(specs, onpoint, onmissing);
+  return deserialize_json_sax(jdata, handler);
+}
+
+
+/// Deserialize json arrays,
+/// extract specific fields from array objects,
+/// return as one vec of point_2t per spec, in spec order.
+///
+/// Input is parsed once for all specs, see
+/// stream_json_array_object_field_n.
+std::vector<vrange>
+deserialize_json_array_object_field_n(const string jdata,
+				      const json_series_specs& specs,
+				      const bool verbosep = true)
+{
+  std::vector<vrange> ret(specs.size());
+  auto onpoint = [&ret](const size_t i, const point_2t& pt)
+  { ret[i].push_back(pt); };
+  if (!stream_json_array_object_field_n(jdata, specs, onpoint, verbosep))
+    for (vrange& vr : ret)
+      vr.clear();
+
+  return ret;
+}
+
+
 /// Deserialize json array,
 /// extract specific fields from array objects,
 /// return as vec of point_2t
 ///
+/// Input is streamed, see stream_json_array_object_field_n.
+///
 /// jdata == input is path + filename of input JSON data file
 /// afield == pointer in json file dom to specific array's data
 /// field1 == x field to extract in array
@@ -212,54 +680,10 @@ deserialize_json_array_object_field_n(const string jdata, const string afield,
 				      const string field1, const string field2,
 				      const bool verbosep = true)
 {
-  vrange ret;
-
-  // Load input JSON data file into DOM.
   // Assuming 2025-era mozilla pageload json input styles, aka
   // /home/bkoz/src/mozilla-a11y-data-visual-forms/data/2025-01-27-minimal.json
-  rj::Document dom(deserialize_json_to_dom(jdata));
-  rj::Value* ap = rj::Pointer(afield.c_str()).Get(dom);
-  if (ap)
-    {
-      const rj::Value& av = *ap;
-      if (av.IsArray())
-	{
-	  for (uint j = 0; j < av.Size(); ++j)
-	    {
-	      double x(0);
-	      double y(0);
-	      const rj::Value& vssub = av[j];
-	      const bool f1p = vssub.HasMember(field1.c_str());
-	      const bool f2p = vssub.HasMember(field2.c_str());
-	      if (f1p)
-		{
-		  const rj::Value& vx = vssub[field1.c_str()];
-		  x = extract_dom_value_to_double(vx);
-		}
-	      if (f2p)
-		{
-		  const rj::Value& vy = vssub[field2.c_str()];
-		  y = extract_dom_value_to_double(vy);
-		}
-
-	      if (f1p && f2p)
-		ret.push_back(std::make_tuple(x, y));
-	      else
-		{
-		  string m("deserialize_json_array_object_field_n:: error ");
-		  m += k::tab;
-		  m += "iteration " + std::to_string(j);
-		  m += " not found";
-		  m += k::newline;
-
-		  if (verbosep)
-		    throw std::runtime_error(m);
-		}
-	    }
-	}
-    }
-
-  return ret;
+  const json_series_specs specs = { { afield, field1, field2 } };
+  return deserialize_json_array_object_field_n(jdata, specs, verbosep)[0];
 }
 
 
@@ -269,29 +693,94 @@ extract_object_keys_as_vspace(const string jdata, const string jobjpath)
 {
   vspace ret;
 
-  rj::Document dom(deserialize_json_to_dom(jdata));
-  rj::Value* ap = rj::Pointer(jobjpath.c_str()).Get(dom);
+  // Keys are always strings in JSON objects.
+  auto onkey = [&ret](const size_t, const string& key)
+  { ret.push_back(space_type(std::atoi(key.c_str()))); };
+
+  json_series_handler handler(jobjpath, onkey);
+  if (!deserialize_json_sax(jdata, handler))
+    ret.clear();
+
+  return ret;
+}
+
+
+/// Cache key for one JSON series.
+string
+make_json_series_cache_key(const json_series_spec& spec)
+{
+  string key("json-series");
+  key += k::newline + spec.pointer;
+  key += k::newline + spec.fieldx;
+  key += k::newline + spec.fieldy;
+  return key;
+}
 
-  // Iterate over the members of the JSON object
-  if (ap)
-    {
-      const rj::Value& obj = *ap;
 
-      using citerator = rj::Value::ConstMemberIterator;
-      for (citerator itr = obj.MemberBegin(); itr != obj.MemberEnd(); ++itr)
+/// As deserialize_json_array_object_field_n, but series already in
+/// cache for an unchanged jdata are not parsed. Missing series are
+/// extracted together in one pass, then stored.
+std::vector<vrange>
+deserialize_json_array_object_field_n(const dataset_cache& cache,
+				      const string jdata,
+				      const json_series_specs& specs,
+				      const bool verbosep = true)
+{
+  std::vector<vrange> ret(specs.size());
+  const uint64_t srchash = dataset_cache::source_hash(jdata);
+
+  json_series_specs missing;
+  std::vector<size_t> missingi;
+  for (size_t i = 0; i < specs.size(); ++i)
+    {
+      const string key = make_json_series_cache_key(specs[i]);
+      if (!srchash || !cache.load(jdata, key, srchash, ret[i]))
 	{
-	  // Get the key (member name), keys are always strings in JSON objects
-	  std::string key = itr->name.GetString();
-	  ret.push_back(space_type(std::atoi(key.c_str())));
+	  missing.push_back(specs[i]);
+	  missingi.push_back(i);
+	}
+    }
 
-	  // Also get the value associated with the key
-	  //const rapidjson::Value& value = itr->value;
+  if (!missing.empty())
+    {
+      std::vector<vrange> parsed =
+	deserialize_json_array_object_field_n(jdata, missing, verbosep);
+      for (size_t j = 0; j < missing.size(); ++j)
+	{
+	  ret[missingi[j]] = std::move(parsed[j]);
+	  if (srchash)
+	    cache.store(jdata, make_json_series_cache_key(missing[j]),
+			srchash, ret[missingi[j]]);
 	}
     }
   return ret;
 }
 
 
+/// Cached single-series form.
+vrange
+deserialize_json_array_object_field_n(const dataset_cache& cache,
+				      const string jdata, const string afield,
+				      const string field1, const string field2,
+				      const bool verbosep = true)
+{
+  const json_series_specs specs = { { afield, field1, field2 } };
+  return deserialize_json_array_object_field_n(cache, jdata, specs,
+					       verbosep)[0];
+}
+
+
+/// Cached form of extract_object_keys_as_vspace.
+vspace
+extract_object_keys_as_vspace(const dataset_cache& cache, const string jdata,
+			      const string jobjpath)
+{
+  const string key("json-keys" + string(1, k::newline) + jobjpath);
+  return cache.get<vspace>(jdata, key, [&]
+			   { return extract_object_keys_as_vspace(jdata,
+								  jobjpath); });
+}
+
 
 /// Convert from input file name to an in-memory vector of strings
 /// representing identifiers/names to match against field names in a
@@ -303,17 +792,18 @@ deserialize_file_to_strings(string ifile)
   sstrings probes;
   if (!ifile.empty())
     {
-      std::ifstream ifs(ifile);
-      if (ifs.good())
+      mapped_file mf(ifile);
+      if (mf.good())
 	{
-	  string line;
-	  do
+	  // Newline terminated lines only, as with getline.
+	  string_view in = mf.view();
+	  auto eol = in.find(k::newline);
+	  while (eol != string_view::npos)
 	    {
-	      std::getline(ifs, line);
-	      if (ifs.good())
-		probes.insert(line);
+	      probes.emplace(in.substr(0, eol));
+	      in.remove_prefix(eol + 1);
+	      eol = in.find(k::newline);
 	    }
-	  while (!ifs.eof());
 
 	  std::clog << probes.size() << " names found in: " << std::endl;
 	  std::clog << ifile << std::endl;
@@ -339,19 +829,15 @@ deserialize_file_to_strings(string ifile)
 /// Convert a comma-space-separated list of strings to a vector of strings
 /// @delim is the delimiter used inbetween values
 /// @cssvp is if there is a space between delimiter and value
+///
+/// Input is memory mapped and scanned once. For row and column
+/// oriented files with quoting, see dsv_reader.
 strings
 deserialize_dsv_file_to_strings(const string& fin, const char delim = k::comma,
 				const bool cssvp = false)
 {
-  std::ifstream ifs(fin);
-  string in;
-  if (ifs.good())
-    {
-      std::ostringstream oss;
-      oss << ifs.rdbuf();
-      in = oss.str();
-    }
-  else
+  mapped_file mf(fin);
+  if (!mf.good())
     {
       std::ostringstream mss;
       mss << "csv_file_to_strings:: cannot open input file ("
@@ -360,15 +846,16 @@ deserialize_dsv_file_to_strings(const string& fin, const char delim = k::comma,
     }
 
   strings vv;
+  string_view in = mf.view();
+  const size_t skip = 1 + static_cast<ushort>(cssvp);
   auto commapos = in.find(delim);
-  while (commapos != string::npos)
+  while (commapos != string_view::npos)
     {
-      string agepv = in.substr(0, commapos);
-      vv.push_back(agepv);
-      in = in.substr(commapos + 1 + static_cast<ushort>(cssvp));
+      vv.emplace_back(in.substr(0, commapos));
+      in.remove_prefix(std::min(in.size(), commapos + skip));
       commapos = in.find(delim);
     }
-  vv.push_back(in);
+  vv.emplace_back(in);
   return vv;
 }
 
@@ -47,10 +47,12 @@ class point_cluster
 {
   double	radius;
   vpoints	points;
+  uint64_t	rindex;		///< Random stream index.
 
 public:
-  point_cluster(const vpoints& input_points, const double r)
-  : radius(r), points(input_points) { }
+  point_cluster(const vpoints& input_points, const double r,
+		const uint64_t ri = svg::next_random_index())
+  : radius(r), points(input_points), rindex(ri) { }
 
   /// Algorithm 1: Grid-based Clustering (Simple and Fast)
   vwpoints
@@ -134,6 +136,8 @@ public:
 
     for (size_t iter = 0; iter < max_iterations; ++iter)
       {
+	MiL_SVG_PROBE3(cluster__iteration, "kmeans", iter, centroids.size());
+
 	// Assign points to nearest centroid within cluster radius
 	for (const auto& point : points)
 	  {
@@ -200,6 +204,8 @@ public:
     }
 
     for (size_t iter = 0; iter < max_iterations; ++iter) {
+      MiL_SVG_PROBE3(cluster__iteration, "voronoi", iter, cells.size());
+
       // Clear current cell points
       for (auto& cell : cells) {
 	cell.points.clear();
@@ -261,8 +267,7 @@ private:
 	std::vector<bool> selected(points.size(), false);
 
 	// Start with a random point
-	std::random_device rd;
-	std::mt19937 gen(rd());
+	svg::random_stream gen(rindex);
 	std::uniform_int_distribution<size_t> dist(0, points.size() - 1);
 
 	size_t first_idx = dist(gen);
@@ -422,9 +427,11 @@ private:
 // Main function interface
 vwpoints
 cluster_points_by(const vpoints& points, double radius,
-		  const std::string& method)
+		  const std::string& method,
+		  const uint64_t rindex = svg::next_random_index())
 {
-  point_cluster clusterer(points, radius);
+  svg::trace_scope ts("cluster_points_by");
+  point_cluster clusterer(points, radius, rindex);
 
   if (method == "grid") {
     return clusterer.reduce_grid();
@@ -68,6 +68,15 @@ using vranged = std::vector<point_2td>;
 
 using vvranges = std::vector<vrange>;
 
+/// Polymorphic allocator variants, see svg::pmr::strings.
+namespace pmr {
+  using vspace = std::pmr::vector<space_type>;
+  using vrange = std::pmr::vector<point_2t>;
+  using vrangei = std::pmr::vector<point_2ti>;
+  using vranged = std::pmr::vector<point_2td>;
+  using vvranges = std::pmr::vector<vrange>;
+} // namespace pmr
+
 using vrangenamed = std::vector<point_2ts>;
 
 
@@ -190,6 +199,64 @@ detect_collision(const point_2t& p1, const int r1,
   return ret;
 }
 
+
+/// Simplify polyline points to within tolerance of the original, as
+/// Douglas-Peucker. End points are kept.
+vrange
+simplify_vrange(const vrange& points, const space_type tolerance)
+{
+  if (points.size() < 3 || tolerance <= 0)
+    return points;
+
+  // Distance of p from the line through a and b.
+  auto offset = [](const point_2t& p, const point_2t& a, const point_2t& b)
+  {
+    auto [ x, y ] = p;
+    auto [ xa, ya ] = a;
+    auto [ xb, yb ] = b;
+    const space_type len = std::hypot(xb - xa, yb - ya);
+    if (len == 0)
+      return distance_cartesian(p, a);
+    return std::abs((xb - xa) * (ya - y) - (xa - x) * (yb - ya)) / len;
+  };
+
+  std::vector<bool> keep(points.size(), false);
+  keep.front() = true;
+  keep.back() = true;
+
+  std::vector<std::pair<size_t, size_t>> spans(1, { 0, points.size() - 1 });
+  while (!spans.empty())
+    {
+      auto [ first, last ] = spans.back();
+      spans.pop_back();
+
+      space_type dmax = 0;
+      size_t imax = first;
+      for (size_t i = first + 1; i < last; ++i)
+	{
+	  const space_type d = offset(points[i], points[first], points[last]);
+	  if (d > dmax)
+	    {
+	      dmax = d;
+	      imax = i;
+	    }
+	}
+
+      if (dmax > tolerance)
+	{
+	  keep[imax] = true;
+	  spans.push_back({ first, imax });
+	  spans.push_back({ imax, last });
+	}
+    }
+
+  vrange ret;
+  for (size_t i = 0; i < points.size(); ++i)
+    if (keep[i])
+      ret.push_back(points[i]);
+  return ret;
+}
+
 } // namespace svg
 
 struct Point
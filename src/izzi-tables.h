@@ -252,20 +252,18 @@ serialize_row_6c_8f(const string moname, const uint btihasz,
 		    const uint weeksn, const string sdates)
 {
   ostringstream oss;
-  oss.imbue(std::locale(""));
-  oss << std::fixed << std::setprecision(0);
 
   oss << "<tr>" << svg::k::newline;
 
   const string td = R"_delimiter_(<td scope="row" class="table-cell">)_delimiter_";
   oss << td << moname << "</td>" << svg::k::newline;
-  oss << td << weeksn << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(weeksn) << "</td>" << svg::k::newline;
   oss << td << sdates << "</td>" << svg::k::newline;
-  oss << td << btihasz << "</td>" << svg::k::newline;
-  oss << td << dl << "</td>" << svg::k::newline;
-  oss << td << dl / btihasz << "</td>" << svg::k::newline;
-  oss << td << ul << "</td>" << svg::k::newline;
-  oss << td << ul / btihasz << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(btihasz) << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(dl) << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(dl / btihasz) << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(ul) << "</td>" << svg::k::newline;
+  oss << td << svg::to_grouped_string(ul / btihasz) << "</td>" << svg::k::newline;
 
   oss << "</tr>" << svg::k::newline;
 